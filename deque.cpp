@@ -1,22 +1,236 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <deque>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+/**
+ * layout:
+ * elements live in fixed-size blocks of raw storage; blocks is a circular map of block pointers
+ * whose live slots run from block_front for blocks_used slots (wrapping around num_blocks).
+ * element i sits at offset index_front + i counted from the start of the first live block.
+ *
+ * growth:
+ * 1. a block is only allocated when a push crosses into it, and freed (or cached) as soon as
+ *    pops empty it, so a deque holds at most two partially used blocks
+ * 2. both ends share the free map slots: pushing at the front takes the slot before block_front,
+ *    pushing at the back the slot after the last live block, so there is nothing to recenter
+ * 3. only when every map slot is live does the map double; that copies block pointers, never elements
+ * 4. emptied blocks go to a small spare-block cache first, so a deque used as a queue keeps
+ *    recycling the same few blocks instead of going through the allocator
+ *
+ * block size:
+ * BlockSize elements per block, by default about 4 KiB worth of T rounded down to a power of two;
+ * with a power of two, finding an element's block and offset is a shift and a mask
+ *
+ * iteration and bulk operations:
+ * 1. iterators are random access; they cache the current block, so ++ and -- only redo the
+ *    block lookup when they cross a block boundary
+ * 2. for_each_segment hands out whole contiguous runs (at most one per block), copy_to and
+ *    append_range copy run by run, with memcpy when T is trivially copyable
+ * 3. insert(pos, first, last) and erase(first, last) move whichever side of pos is shorter
+ */
+
+// about 4 KiB per block, rounded down to a power of two elements
 template <typename T>
+constexpr size_t default_block_size()
+{
+  return std::bit_floor(std::max<size_t>(4096 / sizeof(T), 1));
+}
+
+template <typename T, size_t BlockSize = default_block_size<T>()>
 class Deque
 {
+  static_assert(BlockSize > 0);
+
   private:
+  static constexpr size_t spare_limit = 4;
+  static constexpr size_t block_size  = BlockSize;
+
   T**    blocks;
-  size_t block_size;
-  size_t num_blocks;
-  size_t blocks_used;
+  size_t num_blocks;     // map slots, zero or a power of two
+  size_t blocks_used;    // live blocks, starting at block_front
   size_t block_front;
-  size_t block_back;
-  size_t index_front;
-  size_t index_back;
+  size_t index_front;    // offset of the first element in the first live block
   size_t size_;
+  T*     spare_blocks[spare_limit];
+  size_t num_spare;
+
+  static size_t block_of(size_t position);
+  static size_t offset_of(size_t position);
+  T*&           live_block(size_t n);    // n-th live block
+  T* const&     live_block(size_t n) const;
+  T&            element(size_t index);
+  const T&      element(size_t index) const;
+  T*            acquire_block();
+  void          release_block(T* block);
+  void          grow_map();
+  T*            back_room(size_t& room);
 
   public:
+  template <bool Const>
+  class basic_iterator
+  {
+    using owner = std::conditional_t<Const, const Deque, Deque>;
+
+    public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = T;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = std::conditional_t<Const, const T*, T*>;
+    using reference         = std::conditional_t<Const, const T&, T&>;
+
+    basic_iterator() = default;
+
+    basic_iterator(owner* deq, size_t index) : deq(deq), index(index)
+    {
+      load();
+    }
+
+    operator basic_iterator<true>() const
+      requires(!Const)
+    {
+      return basic_iterator<true>(deq, index);
+    }
+
+    reference operator*() const
+    {
+      return *cur;
+    }
+
+    pointer operator->() const
+    {
+      return cur;
+    }
+
+    reference operator[](difference_type n) const
+    {
+      return *(*this + n);
+    }
+
+    basic_iterator& operator++()
+    {
+      index++;
+      if(++cur == last)
+      {
+        load();
+      }
+      return *this;
+    }
+
+    basic_iterator operator++(int)
+    {
+      basic_iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    basic_iterator& operator--()
+    {
+      index--;
+      if(cur == first)
+      {
+        load();
+      }
+      else
+      {
+        --cur;
+      }
+      return *this;
+    }
+
+    basic_iterator operator--(int)
+    {
+      basic_iterator old = *this;
+      --*this;
+      return old;
+    }
+
+    basic_iterator& operator+=(difference_type n)
+    {
+      index += n;
+      load();
+      return *this;
+    }
+
+    basic_iterator& operator-=(difference_type n)
+    {
+      return *this += -n;
+    }
+
+    friend basic_iterator operator+(basic_iterator it, difference_type n)
+    {
+      return it += n;
+    }
+
+    friend basic_iterator operator+(difference_type n, basic_iterator it)
+    {
+      return it += n;
+    }
+
+    friend basic_iterator operator-(basic_iterator it, difference_type n)
+    {
+      return it -= n;
+    }
+
+    friend difference_type operator-(const basic_iterator& a, const basic_iterator& b)
+    {
+      return static_cast<difference_type>(a.index) - static_cast<difference_type>(b.index);
+    }
+
+    friend bool operator==(const basic_iterator& a, const basic_iterator& b)
+    {
+      return a.index == b.index;
+    }
+
+    friend auto operator<=>(const basic_iterator& a, const basic_iterator& b)
+    {
+      return a.index <=> b.index;
+    }
+
+    size_t position() const
+    {
+      return index;
+    }
+
+    private:
+    owner*  deq   = nullptr;
+    size_t  index = 0;          // logical index in the deque
+    pointer cur   = nullptr;    // element at index, null past the end
+    pointer first = nullptr;    // the block holding cur
+    pointer last  = nullptr;
+
+    void load()
+    {
+      if(index < deq->size_)
+      {
+        cur   = &deq->element(index);
+        first = cur - offset_of(deq->index_front + index);
+        last  = first + BlockSize;
+      }
+      else
+      {
+        cur = first = last = nullptr;
+      }
+    }
+  };
+
+  using iterator       = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
   Deque();
   ~Deque();
+  Deque(const Deque&)            = delete;
+  Deque& operator=(const Deque&) = delete;
   void   push_back(T elem);
   void   push_front(T elem);
   void   pop_back();
@@ -27,279 +241,614 @@ class Deque
   T&     at(size_t index);
   T&     operator[](size_t index);
   size_t size() const;
+  size_t memory_usage() const;    // bytes held by the map, the live blocks and the spare cache
+
+  iterator       begin();
+  iterator       end();
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  template <typename F>
+  void for_each_segment(F f);    // f(T* data, size_t count) per contiguous run, front to back
+  template <typename F>
+  void for_each_segment(F f) const;
+  template <typename OutputIt>
+  OutputIt copy_to(OutputIt out) const;
+  template <typename InputIt>
+  void append_range(InputIt first, InputIt last);
+  template <typename ForwardIt>
+  iterator insert(const_iterator pos, ForwardIt first, ForwardIt last);
+  iterator erase(const_iterator first, const_iterator last);
 };
 
-template <typename T>
-Deque<T>::Deque()
+template <typename T, size_t BlockSize>
+Deque<T, BlockSize>::Deque()
 {
-  num_blocks = 5;
-  block_size = 8;
-  blocks     = new T*[num_blocks];
-  for(int i = 0; i < num_blocks; i++)
-  {
-    blocks[i] = new T[block_size];    // elements are not initialized
-  }
-  // the starting block is the middle block
-  block_front = num_blocks / 2;
-  block_back  = num_blocks / 2;
-  // the starting index of element is at the middle of the block
-  index_front = block_size / 2;
-  index_back  = block_size / 2 - 1;    // ensures start with empty
+  // nothing is allocated until the first push
+  blocks      = nullptr;
+  num_blocks  = 0;
   blocks_used = 0;
+  block_front = 0;
+  index_front = 0;
   size_       = 0;
+  num_spare   = 0;
 }
 
-template <typename T>
-Deque<T>::~Deque()
+template <typename T, size_t BlockSize>
+Deque<T, BlockSize>::~Deque()
 {
-  for(int i = 0; i < num_blocks; i++)
+  while(size_ > 0)
+  {
+    pop_back();
+  }
+  for(size_t i = 0; i < blocks_used; i++)
+  {
+    std::allocator<T>().deallocate(live_block(i), block_size);
+  }
+  for(size_t i = 0; i < num_spare; i++)
   {
-    delete[] blocks[i];
+    std::allocator<T>().deallocate(spare_blocks[i], block_size);
   }
   delete[] blocks;
 }
-/**
- * case breakdown:
- * 0. deque is empty
- *   * just add the element
- * 1. current block is not full
- *   * just add the element
- * 2. current block is full --> further breakdown:
- * 2.1. there is space in the next block
- *   * store the element in next block
- *   * update the indexes
- * 2.2. there is no space in the next block
- *   * create new blocks
- *   * copy the elements to the new blocks
- *   * delete the old blocks
- *   * update the indexes
- */
 
-template <typename T>
-void Deque<T>::push_back(T elem)
+// power-of-two block sizes split a position with a shift and a mask
+template <typename T, size_t BlockSize>
+size_t Deque<T, BlockSize>::block_of(size_t position)
 {
-  //if the deque is empty
-  if(size_ == 0)
+  if constexpr(std::has_single_bit(BlockSize))
   {
-    blocks_used                      = 1;
-    blocks[block_back][++index_back] = elem;
-    size_++;
-    return;
+    return position >> std::countr_zero(BlockSize);
   }
-  // if the block is not full
-  if(index_back < block_size - 1)
+  return position / BlockSize;
+}
+
+template <typename T, size_t BlockSize>
+size_t Deque<T, BlockSize>::offset_of(size_t position)
+{
+  if constexpr(std::has_single_bit(BlockSize))
   {
-    blocks[block_back][++index_back] = elem;
-    size_++;
-    return;
+    return position & (BlockSize - 1);
   }
-  // *********************
-  // if current block is full
-  //***********************
-  // if the next block is not full, move to it
-  if(block_back < num_blocks - 1)
+  return position % BlockSize;
+}
+
+template <typename T, size_t BlockSize>
+T*& Deque<T, BlockSize>::live_block(size_t n)
+{
+  return blocks[(block_front + n) & (num_blocks - 1)];
+}
+
+template <typename T, size_t BlockSize>
+T* const& Deque<T, BlockSize>::live_block(size_t n) const
+{
+  return blocks[(block_front + n) & (num_blocks - 1)];
+}
+
+template <typename T, size_t BlockSize>
+T& Deque<T, BlockSize>::element(size_t index)
+{
+  const size_t position = index_front + index;
+  return live_block(block_of(position))[offset_of(position)];
+}
+
+template <typename T, size_t BlockSize>
+const T& Deque<T, BlockSize>::element(size_t index) const
+{
+  const size_t position = index_front + index;
+  return live_block(block_of(position))[offset_of(position)];
+}
+
+template <typename T, size_t BlockSize>
+T* Deque<T, BlockSize>::acquire_block()
+{
+  if(num_spare > 0)
   {
-    index_back                       = 0;
-    blocks[++block_back][index_back] = elem;
-    size_++;
-    blocks_used++;
+    return spare_blocks[--num_spare];
+  }
+  return std::allocator<T>().allocate(block_size);
+}
+
+template <typename T, size_t BlockSize>
+void Deque<T, BlockSize>::release_block(T* block)
+{
+  if(num_spare < spare_limit)
+  {
+    spare_blocks[num_spare++] = block;
     return;
   }
+  std::allocator<T>().deallocate(block, block_size);
+}
 
-  // if the next block is full, allocate new blocks
-  //  0 1 1 1 -> 0 0 1 1 1 1 0 0  (8-3)/2 = 2
-  size_t old_block_front = block_front;
-  num_blocks *= 2;
-  index_back = 0;
-  blocks_used++;
-  size_++;
-  block_front    = (num_blocks - blocks_used) / 2;
-  block_back     = block_front + blocks_used - 1;
-  T** new_blocks = new T*[num_blocks];
-  for(size_t i = 0; i < block_front; i++)
+// unrolls the live blocks to the start of a map twice the size
+template <typename T, size_t BlockSize>
+void Deque<T, BlockSize>::grow_map()
+{
+  const size_t new_num_blocks = num_blocks == 0 ? 8 : 2 * num_blocks;
+  T**          new_blocks     = new T*[new_num_blocks]();
+  for(size_t i = 0; i < blocks_used; i++)
+  {
+    new_blocks[i] = live_block(i);
+  }
+  delete[] blocks;
+  blocks      = new_blocks;
+  num_blocks  = new_num_blocks;
+  block_front = 0;
+}
+
+// first free slot at the back, linking a fresh block when the last one is full; room is the number
+// of free slots in that block. a fresh block must be written to before anything can throw
+template <typename T, size_t BlockSize>
+T* Deque<T, BlockSize>::back_room(size_t& room)
+{
+  const size_t position = index_front + size_;
+  if(position < blocks_used * block_size)
   {
-    new_blocks[i] = new T[block_size];    // allocate new blocks
+    room = block_size - offset_of(position);
+    return &live_block(block_of(position))[offset_of(position)];
   }
-  for(size_t i = block_front; i < block_back; i++)
+  if(blocks_used == num_blocks)
   {
-    new_blocks[i] = blocks[old_block_front++];    // reuse old blocks
+    grow_map();
   }
-  for(size_t i = block_back; i < num_blocks; i++)
+  T* block = acquire_block();
+  if(blocks_used == 0)
   {
-    new_blocks[i] = new T[block_size];    // allocate new blocks
+    index_front = 0;
   }
-  new_blocks[block_back][0] = elem;
-  // only delete the ptrptr**
-  T** temp = blocks;
-  blocks   = new_blocks;
-  delete[] temp;
-
-  // std::cout << "Blocks:      " << num_blocks << std::endl;
-  // std::cout << "Blocks used: " << blocks_used << std::endl;
-  // std::cout << "Block front: " << block_front << std::endl;
-  // std::cout << "Block back:  " << block_back << std::endl;
-  // std::cout << "Index front: " << index_front << std::endl;
-  // std::cout << "Index back:  " << index_back << std::endl;
-  // std::cout << std::endl << std::endl;
+  live_block(blocks_used) = block;
+  blocks_used++;
+  room = block_size;
+  return block;
 }
-// reverse the push_back
-template <typename T>
-void Deque<T>::push_front(T elem)
+
+/**
+ * case breakdown:
+ * 1. the slot after the last element is inside a live block
+ *   * construct the element there
+ * 2. the last live block is full (or there is none)
+ *   * double the map first if every slot is live
+ *   * take a block from the spare cache or the allocator
+ *   * construct the element in it, then link it after the last live block
+ *   * an empty deque starts in the middle of its first block, leaving room for push_front
+ */
+template <typename T, size_t BlockSize>
+void Deque<T, BlockSize>::push_back(T elem)
 {
-  //if the deque is empty
-  if(size_ == 0)
+  const size_t position = index_front + size_;
+  if(position < blocks_used * block_size)
   {
-    blocks_used                        = 1;
-    blocks[block_front][--index_front] = elem;
+    ::new(static_cast<void*>(&live_block(block_of(position))[offset_of(position)])) T(std::move(elem));
     size_++;
     return;
   }
-  // if the block is not full
-  if(index_front > 0)
+
+  if(blocks_used == num_blocks)
   {
-    blocks[block_front][--index_front] = elem;
-    size_++;
-    return;
+    grow_map();    // first: if it throws, there is nothing to undo
+  }
+  T*           block  = acquire_block();
+  const size_t offset = blocks_used == 0 ? block_size / 2 : 0;
+  try
+  {
+    ::new(static_cast<void*>(block + offset)) T(std::move(elem));
+  }
+  catch(...)
+  {
+    release_block(block);
+    throw;
+  }
+  if(blocks_used == 0)
+  {
+    index_front = offset;
   }
-  // *********************
-  // if the block is full
-  //***********************
-  // if the prior block is not full, move to it
-  if(block_front > 0)
+  live_block(blocks_used) = block;
+  blocks_used++;
+  size_++;
+}
+
+// reverse the push_back
+template <typename T, size_t BlockSize>
+void Deque<T, BlockSize>::push_front(T elem)
+{
+  if(blocks_used > 0 && index_front > 0)
   {
-    index_front                        = block_size - 1;
-    blocks[--block_front][index_front] = elem;
+    ::new(static_cast<void*>(&live_block(0)[index_front - 1])) T(std::move(elem));
+    index_front--;
     size_++;
-    blocks_used++;
     return;
   }
 
-  // if the next block is full, allocate new blocks
-  //   1 1 1 0 -> 0 0 1 1 1 1 0 0  (8-3)/2 = 2
-  size_t old_block_front = block_front;
-  num_blocks *= 2;
-  index_front = block_size - 1;
-  blocks_used++;
-  size_++;
-  block_front    = (num_blocks - blocks_used) / 2;
-  block_back     = block_front + blocks_used - 1;
-  T** new_blocks = new T*[num_blocks];
-  for(size_t i = 0; i < block_front; i++)
+  if(blocks_used == num_blocks)
   {
-    new_blocks[i] = new T[block_size];    // allocate new blocks
+    grow_map();
   }
-  for(size_t i = block_front; i < block_back; i++)
+  T*           block  = acquire_block();
+  const size_t offset = blocks_used == 0 ? block_size / 2 : block_size - 1;
+  try
   {
-    new_blocks[i] = blocks[old_block_front++];    // reuse old blocks
+    ::new(static_cast<void*>(block + offset)) T(std::move(elem));
   }
-  for(size_t i = block_back; i < num_blocks; i++)
+  catch(...)
   {
-    new_blocks[i] = new T[block_size];    // allocate new blocks
+    release_block(block);
+    throw;
   }
-  new_blocks[block_front][index_front] = elem;
-  // only delete the ptrptr**
-  T** temp = blocks;
-  blocks   = new_blocks;
-  delete[] temp;
-
-  // std::cout << "Blocks:      " << num_blocks << std::endl;
-  // std::cout << "Blocks used: " << blocks_used << std::endl;
-  // std::cout << "Block front: " << block_front << std::endl;
-  // std::cout << "Block back:  " << block_back << std::endl;
-  // std::cout << "Index front: " << index_front << std::endl;
-  // std::cout << "Index back:  " << index_back << std::endl;
-  // std::cout << std::endl << std::endl;
+  block_front         = (block_front + num_blocks - 1) & (num_blocks - 1);
+  blocks[block_front] = block;
+  blocks_used++;
+  index_front = offset;
+  size_++;
 }
 
-template <typename T>
-void Deque<T>::pop_back()
+template <typename T, size_t BlockSize>
+void Deque<T, BlockSize>::pop_back()
 {
   if(size_ == 0)
+  {
     return;
-  // if the back index is not 0
+  }
   size_--;
-  blocks[block_back][index_back] = std::numeric_limits<T>::max();    // register an error signal
-  index_back--;
-  // if the back index is 0, move to prior block
-  if(index_back == std::numeric_limits<size_t>::max())    // if(int(index_back) == -1)
+  const size_t position = index_front + size_;
+  std::destroy_at(&live_block(block_of(position))[offset_of(position)]);
+  // the popped element was the first one in its block: the block is empty now
+  if(offset_of(position) == 0)
   {
-    index_back = block_size - 1;
-    block_back--;
+    release_block(live_block(blocks_used - 1));
+    blocks_used--;
   }
 }
 
-template <typename T>
-void Deque<T>::pop_front()
+template <typename T, size_t BlockSize>
+void Deque<T, BlockSize>::pop_front()
 {
   if(size_ == 0)
   {
     return;
   }
-  // if the back index is not 0
+  std::destroy_at(&live_block(0)[index_front]);
   size_--;
-  blocks[block_front][index_front] = std::numeric_limits<T>::max();    // register an error signal
   index_front++;
-  // if the back index is 0
+  // the popped element was the last one in its block: the block is empty now
   if(index_front == block_size)
   {
-    block_front++;
+    release_block(live_block(0));
+    block_front = (block_front + 1) & (num_blocks - 1);
+    blocks_used--;
     index_front = 0;
   }
 }
 
-template <typename T>
-T Deque<T>::back()
+template <typename T, size_t BlockSize>
+T Deque<T, BlockSize>::back()
 {
-  return blocks[block_back][index_back];
+  return element(size_ - 1);
 }
 
-template <typename T>
-T Deque<T>::front()
+template <typename T, size_t BlockSize>
+T Deque<T, BlockSize>::front()
 {
-  return blocks[block_front][index_front];
+  return element(0);
 }
-template <typename T>
-bool Deque<T>::empty()
+template <typename T, size_t BlockSize>
+bool Deque<T, BlockSize>::empty()
 {
   return size_ == 0;
 }
-template <typename T>
-T& Deque<T>::operator[](size_t index)    // do not perform boundary checking
+template <typename T, size_t BlockSize>
+T& Deque<T, BlockSize>::operator[](size_t index)    // do not perform boundary checking
 {
-  const size_t remain = block_size - index_front;
-  if(index < remain)
-  {
-    return blocks[block_front][index_front + index];
-  }
-  size_t curr_block = block_front + (index + remain) / block_size;
-  size_t curr_index = (index + remain) % block_size;
-  return blocks[curr_block][curr_index];
+  return element(index);
 }
 
-template <typename T>
-T& Deque<T>::at(size_t index)    // perform boundary checking
+template <typename T, size_t BlockSize>
+T& Deque<T, BlockSize>::at(size_t index)    // perform boundary checking
 {
   if(index >= size_)
   {
     throw std::out_of_range("Deque::at() index out of range");
   }
-  const size_t remain = block_size - index_front;
-  if(index < remain)
+  return element(index);
+}
+
+template <typename T, size_t BlockSize>
+size_t Deque<T, BlockSize>::size() const
+{
+  return size_;
+}
+
+template <typename T, size_t BlockSize>
+size_t Deque<T, BlockSize>::memory_usage() const
+{
+  return num_blocks * sizeof(T*) + (blocks_used + num_spare) * block_size * sizeof(T);
+}
+
+template <typename T, size_t BlockSize>
+typename Deque<T, BlockSize>::iterator Deque<T, BlockSize>::begin()
+{
+  return iterator(this, 0);
+}
+
+template <typename T, size_t BlockSize>
+typename Deque<T, BlockSize>::iterator Deque<T, BlockSize>::end()
+{
+  return iterator(this, size_);
+}
+
+template <typename T, size_t BlockSize>
+typename Deque<T, BlockSize>::const_iterator Deque<T, BlockSize>::begin() const
+{
+  return const_iterator(this, 0);
+}
+
+template <typename T, size_t BlockSize>
+typename Deque<T, BlockSize>::const_iterator Deque<T, BlockSize>::end() const
+{
+  return const_iterator(this, size_);
+}
+
+template <typename T, size_t BlockSize>
+template <typename F>
+void Deque<T, BlockSize>::for_each_segment(F f)
+{
+  for(size_t index = 0; index < size_;)
+  {
+    const size_t count = std::min(size_ - index, block_size - offset_of(index_front + index));
+    f(&element(index), count);
+    index += count;
+  }
+}
+
+template <typename T, size_t BlockSize>
+template <typename F>
+void Deque<T, BlockSize>::for_each_segment(F f) const
+{
+  for(size_t index = 0; index < size_;)
+  {
+    const size_t count = std::min(size_ - index, block_size - offset_of(index_front + index));
+    f(&element(index), count);
+    index += count;
+  }
+}
+
+// copies every element to out, one run at a time; returns the end of the output
+template <typename T, size_t BlockSize>
+template <typename OutputIt>
+OutputIt Deque<T, BlockSize>::copy_to(OutputIt out) const
+{
+  for_each_segment([&](const T* data, size_t count) {
+    if constexpr(std::is_same_v<OutputIt, T*> && std::is_trivially_copyable_v<T>)
+    {
+      std::memcpy(out, data, count * sizeof(T));
+      out += count;
+    }
+    else
+    {
+      out = std::copy_n(data, count, out);
+    }
+  });
+  return out;
+}
+
+// pushes [first, last) at the back; contiguous ranges of a trivially copyable T are copied
+// into the free tail of each block with one memcpy per block
+template <typename T, size_t BlockSize>
+template <typename InputIt>
+void Deque<T, BlockSize>::append_range(InputIt first, InputIt last)
+{
+  if constexpr(std::contiguous_iterator<InputIt> && std::is_trivially_copyable_v<T>
+               && std::is_same_v<std::iter_value_t<InputIt>, T>)
   {
-    return blocks[block_front][index_front + index];
+    const T* from      = std::to_address(first);
+    size_t   remaining = static_cast<size_t>(last - first);
+    while(remaining > 0)
+    {
+      size_t       room;
+      T*           to    = back_room(room);
+      const size_t count = std::min(room, remaining);
+      std::memcpy(to, from, count * sizeof(T));
+      size_ += count;
+      from += count;
+      remaining -= count;
+    }
+  }
+  else
+  {
+    for(; first != last; ++first)
+    {
+      push_back(*first);
+    }
   }
-  const size_t curr_block = block_front + (index + remain) / block_size;
-  const size_t curr_index = (index + remain) % block_size;
-  return blocks[curr_block][curr_index];
 }
 
+/**
+ * insert breakdown, k = elements before pos, n = new elements:
+ * 1. k is at most half the size: push the new elements at the front, reverse them into order,
+ *    then rotate them past the k old ones: O(k + n)
+ * 2. otherwise push them at the back and rotate the size - k old elements after pos past them
+ */
+template <typename T, size_t BlockSize>
+template <typename ForwardIt>
+typename Deque<T, BlockSize>::iterator Deque<T, BlockSize>::insert(const_iterator pos, ForwardIt first,
+                                                                   ForwardIt last)
+{
+  const size_t k        = pos.position();
+  const size_t old_size = size_;
+  if(k <= size_ / 2)
+  {
+    size_t n = 0;
+    for(; first != last; ++first, ++n)
+    {
+      push_front(*first);
+    }
+    std::reverse(begin(), begin() + n);
+    std::rotate(begin(), begin() + n, begin() + n + k);
+  }
+  else
+  {
+    append_range(first, last);
+    std::rotate(begin() + k, begin() + old_size, end());
+  }
+  return begin() + k;
+}
+
+/**
+ * erase breakdown, k = elements before first, n = erased elements:
+ * 0. empty range: return at once, moving the tail onto itself would empty non-trivial elements
+ * 1. fewer elements before the range than after it: move the k front elements back by n,
+ *    then pop n from the front
+ * 2. otherwise move the elements after the range forward by n and pop n from the back
+ */
+template <typename T, size_t BlockSize>
+typename Deque<T, BlockSize>::iterator Deque<T, BlockSize>::erase(const_iterator first, const_iterator last)
+{
+  const size_t k = first.position();
+  const size_t n = last.position() - k;
+  if(n == 0)
+  {
+    return begin() + k;
+  }
+  if(k < size_ - k - n)
+  {
+    std::move_backward(begin(), begin() + k, begin() + k + n);
+    for(size_t i = 0; i < n; i++)
+    {
+      pop_front();
+    }
+  }
+  else
+  {
+    std::move(begin() + k + n, end(), begin() + k);
+    for(size_t i = 0; i < n; i++)
+    {
+      pop_back();
+    }
+  }
+  return begin() + k;
+}
+
+// ns per operation for push_back, push_front, pop_front, pop_back and random operator[]
+template <size_t BlockSize>
+void benchmark_block_size()
+{
+  constexpr size_t n = size_t(1) << 20;
+
+  auto time = [](auto body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / n;
+  };
+
+  Deque<int, BlockSize> deq;
+  size_t                sink = 0;
+
+  const double push_back_ns = time([&] {
+    for(size_t i = 0; i < n; i++)
+      deq.push_back(static_cast<int>(i));
+  });
+  const double push_front_ns = time([&] {
+    for(size_t i = 0; i < n; i++)
+      deq.push_front(static_cast<int>(i));
+  });
+
+  std::mt19937        rng(1);
+  std::vector<size_t> indexes(n);
+  for(size_t& index : indexes)
+    index = rng() % deq.size();
+  const double random_ns = time([&] {
+    for(size_t index : indexes)
+      sink += static_cast<size_t>(deq[index]);
+  });
+  const double pop_front_ns = time([&] {
+    for(size_t i = 0; i < n; i++)
+      deq.pop_front();
+  });
+  const double pop_back_ns = time([&] {
+    for(size_t i = 0; i < n; i++)
+      deq.pop_back();
+  });
+  std::cout << BlockSize << "\t" << push_back_ns << "\t" << push_front_ns << "\t" << pop_front_ns << "\t"
+            << pop_back_ns << "\t" << random_ns << "\t(" << sink % 10 << ")" << std::endl;
+}
+
+// counts the bytes std::deque holds, to compare its footprint with Deque::memory_usage
 template <typename T>
-size_t Deque<T>::size() const
+struct CountingAllocator
 {
-  return size_;
+  using value_type = T;
+
+  size_t* bytes;
+
+  explicit CountingAllocator(size_t* bytes) : bytes(bytes) {}
+
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U>& other) : bytes(other.bytes)
+  {
+  }
+
+  T* allocate(size_t n)
+  {
+    *bytes += n * sizeof(T);
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* p, size_t n)
+  {
+    *bytes -= n * sizeof(T);
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  friend bool operator==(const CountingAllocator& a, const CountingAllocator& b)
+  {
+    return a.bytes == b.bytes;
+  }
+};
+
+// heap held and push_back time for 1M ints, against std::deque
+void benchmark_footprint()
+{
+  constexpr size_t n = size_t(1) << 20;
+
+  auto time_ms = [](auto body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+  };
+
+  Deque<int>   deq;
+  const double deque_ms = time_ms([&] {
+    for(size_t i = 0; i < n; i++)
+      deq.push_back(static_cast<int>(i));
+  });
+
+  size_t                                  std_bytes = 0;
+  std::deque<int, CountingAllocator<int>> reference{CountingAllocator<int>(&std_bytes)};
+  const double                            std_ms = time_ms([&] {
+    for(size_t i = 0; i < n; i++)
+      reference.push_back(static_cast<int>(i));
+  });
+
+  std::cout << "1M push_back	heap (MB)	time (ms)" << std::endl;
+  std::cout << "Deque		" << deq.memory_usage() / 1e6 << "		" << deque_ms << std::endl;
+  std::cout << "std::deque	" << std_bytes / 1e6 << "		" << std_ms << std::endl;
 }
 
-int main()
+void benchmark_deque()
+{
+  benchmark_footprint();
+  std::cout << "block\tpush_back\tpush_front\tpop_front\tpop_back\trandom [] (ns/op)" << std::endl;
+  benchmark_block_size<8>();
+  benchmark_block_size<64>();
+  benchmark_block_size<256>();
+  benchmark_block_size<default_block_size<int>()>();
+  benchmark_block_size<1000>();    // not a power of two: division instead of shift/mask
+  benchmark_block_size<4096>();
+  benchmark_block_size<16384>();
+}
+
+int main(int argc, char** argv)
 {
   Deque<int> deq;
   std::cout << "-----push_back test-----" << std::endl;
@@ -329,14 +878,42 @@ int main()
   std::cout << "\n-----operator[] test-----" << std::endl;
   for(int i = 0; i < 11; i++)
     deq.push_back(i);
-  for(int i = 0; i < 12; i++)
+  for(size_t i = 0; i < deq.size(); i++)
   {
     std::cout << deq[i] << ' ';
   }
   std::cout << "\n-----at() test-----" << std::endl;
   std::cout << deq.size() << std::endl;
-  for(int i = 0; i < 12; i++)
+  try
+  {
+    for(size_t i = 0; i < 12; i++)
+    {
+      std::cout << deq.at(i) << ' ';
+    }
+  }
+  catch(const std::out_of_range& e)
   {
-    std::cout << deq.at(i) << ' ';
+    std::cout << "\n" << e.what() << std::endl;
   }
-}
\ No newline at end of file
+
+  std::cout << "-----bulk test-----" << std::endl;
+  const int batch[] = {100, 101, 102, 103};
+  deq.append_range(std::begin(batch), std::end(batch));
+  deq.insert(deq.begin() + 2, std::begin(batch), std::begin(batch) + 2);
+  deq.erase(deq.begin() + 5, deq.begin() + 9);
+  std::sort(deq.begin(), deq.end());
+  std::vector<int> drained(deq.size());
+  deq.copy_to(drained.data());
+  size_t segments = 0;
+  deq.for_each_segment([&](int*, size_t) { segments++; });
+  for(int value : drained)
+  {
+    std::cout << value << ' ';
+  }
+  std::cout << "(" << segments << " segments)" << std::endl;
+
+  if(argc > 1 && std::string_view(argv[1]) == "--bench")
+  {
+    benchmark_deque();
+  }
+}
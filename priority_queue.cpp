@@ -1,4 +1,16 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <queue>
+#include <random>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 /*
@@ -8,7 +20,7 @@ at the expense of logarithmic insertion and extraction.
 
 Structure Property:
 The std::priority_queue typically uses a binary heap as the underlying data structure
-A binary heap is a complete binary tree in which every level, except possibly the last, 
+A binary heap is a complete binary tree in which every level, except possibly the last,
 is *completely filled*, and all nodes are as *left* as possible.
 
 Order Property:
@@ -19,17 +31,82 @@ For a given element at index i:
 - The left child is at index 2i+1
 - The right child is at index 2i+2
 - The parent is at index (i−1)/2 (integer division)
+
+d-ary heap (Arity = d):
+- The children of i are at indices d*i+1 ... d*i+d
+- The parent is at index (i-1)/d
+A wider node makes the tree log2(d) times shallower, so sift-down visits fewer levels; each level compares d
+children, but they are adjacent. SiblingAlignedAllocator shifts the storage so that index 1 starts a cache line:
+with d*sizeof(T) dividing or a multiple of 64 bytes, each group of siblings shares one line (or starts one).
+
+Sifting moves a "hole" instead of swapping:
+the moving element is lifted out once, parents (or the best child) slide into the hole level by level,
+and the element is written once where the hole stops; one move per level instead of a three-move swap.
+
+PairingHeap:
+a heap-ordered multiway tree (leftmost child, right sibling); push and merge link two roots in O(1),
+pop pairs up the root's children left to right, then folds the pairs right to left (amortized O(log n)).
+pop destroys the element at once; up to 64 emptied nodes are kept for later pushes, the rest are freed.
+
+IndexedPriorityQueue:
+a d-ary heap of (value, handle) entries plus a position map handle -> heap index; every move of an entry in
+a sift writes its new index into the map, so the entry for a handle is found in O(1) and can be re-sifted
+or removed in O(log n). handles are small integers, recycled once their element leaves the heap.
+As in Boost.Heap, "increase" and "decrease" follow Compare: increase_key moves an element toward top,
+decrease_key away from it; with std::greater (a min-heap), lowering a distance is an increase_key.
 */
 
+// storage for heap arrays: element 1, the first child of the root, starts a 64-byte cache line
+template <typename T>
+struct SiblingAlignedAllocator
+{
+  static_assert(alignof(T) <= 64);
+
+  using value_type = T;
+
+  static constexpr size_t line   = 64;
+  static constexpr size_t offset = (line - sizeof(T) % line) % line;    // bytes before element 0
+
+  SiblingAlignedAllocator() = default;
+
+  template <typename U>
+  SiblingAlignedAllocator(const SiblingAlignedAllocator<U>&)
+  {
+  }
+
+  T* allocate(size_t n)
+  {
+    void* base = ::operator new(n * sizeof(T) + offset, std::align_val_t(line));
+    return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+  }
+
+  void deallocate(T* p, size_t)
+  {
+    ::operator delete(reinterpret_cast<char*>(p) - offset, std::align_val_t(line));
+  }
+
+  template <typename U>
+  bool operator==(const SiblingAlignedAllocator<U>&) const
+  {
+    return true;
+  }
+};
+
 template <typename T,
-          typename Container = std::vector<T>,
-          typename Compare   = std::less<T> >
+          typename Container = std::vector<T, SiblingAlignedAllocator<T>>,
+          typename Compare   = std::less<T>,
+          size_t Arity       = 2>
 class PriorityQueue
 {
+  static_assert(Arity >= 2);
+
   public:
-  PriorityQueue()
+  PriorityQueue() = default;
+
+  template <typename InputIt>
+  PriorityQueue(InputIt first, InputIt last) : container(first, last)
   {
-    make_heap(0, container.size() - 1, 0);
+    make_heap();
   }
 
   T& top()
@@ -37,10 +114,26 @@ class PriorityQueue
     return container.front();
   }
 
+  bool empty() const
+  {
+    return container.empty();
+  }
+
+  size_t size() const
+  {
+    return container.size();
+  }
+
   void push(const T& value)
   {
     container.push_back(value);
-    push_heap(0, container.size() - 1);
+    push_heap();
+  }
+
+  void push(T&& value)
+  {
+    container.push_back(std::move(value));
+    push_heap();
   }
 
   void pop()
@@ -50,72 +143,703 @@ class PriorityQueue
       return;
     }
     pop_heap();
-    container.pop_back();
   }
 
   private:
   Container container;
   Compare   compare;
 
-  //ensures the max heap property is maintained for the subtree rooted at i
-  void heapify(size_t first, size_t last, size_t index)
+  //restores the heap property below index for value, which is about to fill the hole at index.
+  //Floyd's variant: the hole first follows the best child all the way to a leaf without comparing against
+  //value (a popped root's replacement is a leaf, so it nearly always belongs near the bottom), then value
+  //climbs back up from there
+  void sift_down(size_t index, T value)
   {
-    const auto size    = last - first + 1;
-    auto       left    = 2 * index + 1;
-    auto       right   = 2 * index + 2;
-    auto       largest = index;
+    const size_t size  = container.size();
+    const size_t start = index;
+    while(true)
+    {
+      const size_t first = Arity * index + 1;
+      if(first >= size)
+      {
+        break;
+      }
+      const size_t last = std::min(first + Arity, size);
+      size_t       best = first;
+      for(size_t child = first + 1; child < last; child++)
+      {
+        best = compare(container[best], container[child]) ? child : best;
+      }
+      container[index] = std::move(container[best]);
+      index            = best;
+    }
+    sift_up(index, start, std::move(value));
+  }
 
-    if(left < size && compare(container[largest], container[left]))
+  //fills the hole at index with value, letting smaller parents slide down into it, but not above top
+  void sift_up(size_t index, size_t top, T value)
+  {
+    while(index > top)
     {
-      largest = left;
+      const size_t parent = (index - 1) / Arity;
+      if(!compare(container[parent], value))
+      {
+        break;
+      }
+      container[index] = std::move(container[parent]);
+      index            = parent;
     }
-    if(right < size && compare(container[largest], container[right]))
+    container[index] = std::move(value);
+  }
+
+  //builds a (max) heap from an unsorted range of elements.
+  //It starts from the last parent and sifts each subtree down in a bottom-up manner.
+  void make_heap()
+  {
+    const size_t size = container.size();
+    if(size < 2)
     {
-      largest = right;
+      return;
     }
-    if(largest != index)
+    for(size_t i = (size - 2) / Arity + 1; i-- > 0;)    // start from the last parent!
     {
-      std::swap(container[index], container[largest]);
-      heapify(first, last, largest);
+      sift_down(i, std::move(container[i]));
     }
   }
-  //builds a (max) heap from an unsorted range of elements.
-  //It starts from the middle of the array and
-  //heapifies each subtree in a bottom-up manner.
-  void make_heap(size_t first, size_t last, size_t index)
+
+  //moves the last element into the root's hole and sifts it down
+  void pop_heap()
   {
-    const auto size = last - first + 1;
-    for(int i = size / 2 - 1; i >= 0; i--)    // start from the middle node!
+    T last = std::move(container.back());
+    container.pop_back();
+    if(!container.empty())
     {
-      heapify(first, last, first + i);
+      sift_down(0, std::move(last));
     }
   }
 
-  void pop_heap()
+  //lifts the new last element out and sifts it up
+  void push_heap()
   {
-    if(container.empty())
+    const size_t index = container.size() - 1;
+    sift_up(index, 0, std::move(container[index]));
+  }
+};
+
+template <typename T, typename Compare = std::less<T>>
+class PairingHeap
+{
+  public:
+  PairingHeap() = default;
+
+  PairingHeap(const PairingHeap&)            = delete;
+  PairingHeap& operator=(const PairingHeap&) = delete;
+
+  PairingHeap(PairingHeap&& other) noexcept
+      : root(std::exchange(other.root, nullptr)),
+        spare(std::exchange(other.spare, nullptr)),
+        count(std::exchange(other.count, 0)),
+        num_spare(std::exchange(other.num_spare, 0))
+  {
+  }
+
+  PairingHeap& operator=(PairingHeap&& other) noexcept
+  {
+    if(this != &other)
+    {
+      free_nodes();
+      root      = std::exchange(other.root, nullptr);
+      spare     = std::exchange(other.spare, nullptr);
+      count     = std::exchange(other.count, 0);
+      num_spare = std::exchange(other.num_spare, 0);
+    }
+    return *this;
+  }
+
+  ~PairingHeap()
+  {
+    free_nodes();
+  }
+
+  T& top()
+  {
+    return root->value();
+  }
+
+  bool empty() const
+  {
+    return root == nullptr;
+  }
+
+  size_t size() const
+  {
+    return count;
+  }
+
+  void push(const T& value)
+  {
+    root = link(root, make_node(value));
+    count++;
+  }
+
+  void push(T&& value)
+  {
+    root = link(root, make_node(std::move(value)));
+    count++;
+  }
+
+  void pop()
+  {
+    if(root == nullptr)
+    {
+      return;
+    }
+    Node* old = root;
+    root      = combine_children(old->child);
+    recycle(old);
+    count--;
+  }
+
+  //moves every element of other into this heap in O(1); other is left empty
+  void merge(PairingHeap& other)
+  {
+    if(this == &other)
+    {
+      return;
+    }
+    root  = link(root, std::exchange(other.root, nullptr));
+    count += std::exchange(other.count, 0);
+  }
+
+  private:
+  static constexpr size_t spare_limit = 64;
+
+  // value lives in raw storage: it is constructed by make_node and destroyed by recycle,
+  // so a spare node holds no element
+  struct Node
+  {
+    Node* child   = nullptr;    // leftmost child
+    Node* sibling = nullptr;    // next sibling to the right
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    T& value()
+    {
+      return *std::launder(reinterpret_cast<T*>(storage));
+    }
+  };
+
+  Node*   root      = nullptr;
+  Node*   spare     = nullptr;    // empty nodes, linked through sibling, reused by push
+  size_t  count     = 0;
+  size_t  num_spare = 0;          // at most spare_limit
+  Compare compare;
+
+  template <typename U>
+  Node* make_node(U&& value)
+  {
+    Node* node;
+    if(spare == nullptr)
+    {
+      node = new Node;
+    }
+    else
+    {
+      node          = spare;
+      spare         = spare->sibling;
+      node->sibling = nullptr;
+      num_spare--;
+    }
+    try
+    {
+      std::construct_at(&node->value(), std::forward<U>(value));
+    }
+    catch(...)
+    {
+      release(node);
+      throw;
+    }
+    return node;
+  }
+
+  //destroys the element; the empty node is kept for the next push unless the cache is full
+  void recycle(Node* node)
+  {
+    std::destroy_at(&node->value());
+    release(node);
+  }
+
+  void release(Node* node)
+  {
+    if(num_spare == spare_limit)
+    {
+      delete node;
+      return;
+    }
+    node->child   = nullptr;
+    node->sibling = spare;
+    spare         = node;
+    num_spare++;
+  }
+
+  //the root with the smaller value becomes the leftmost child of the other
+  Node* link(Node* a, Node* b)
+  {
+    if(a == nullptr)
+    {
+      return b;
+    }
+    if(b == nullptr)
+    {
+      return a;
+    }
+    if(compare(a->value(), b->value()))
+    {
+      std::swap(a, b);
+    }
+    b->sibling = a->child;
+    a->child   = b;
+    return a;
+  }
+
+  //two-pass pairing: link neighbours left to right, then fold the pairs from the right
+  Node* combine_children(Node* first)
+  {
+    Node* pairs = nullptr;    // linked pairs, last one first, chained through sibling
+    while(first != nullptr)
+    {
+      Node* a    = first;
+      Node* b    = a->sibling;
+      first      = b != nullptr ? b->sibling : nullptr;
+      a->sibling = nullptr;
+      if(b != nullptr)
+      {
+        b->sibling = nullptr;
+      }
+      Node* pair    = link(a, b);
+      pair->sibling = pairs;
+      pairs         = pair;
+    }
+    Node* result = nullptr;
+    while(pairs != nullptr)
+    {
+      Node* next     = pairs->sibling;
+      pairs->sibling = nullptr;
+      result         = link(result, pairs);
+      pairs          = next;
+    }
+    return result;
+  }
+
+  //destroys every element and deletes every node, spares included
+  void free_nodes()
+  {
+    free_tree(root);
+    while(spare != nullptr)
+    {
+      delete std::exchange(spare, spare->sibling);
+    }
+  }
+
+  //deletes a whole tree without recursion by splicing each child list in front of the pending list
+  static void free_tree(Node* pending)
+  {
+    while(pending != nullptr)
+    {
+      Node* node = pending;
+      pending    = node->sibling;
+      if(Node* child = node->child)
+      {
+        Node* tail = child;
+        while(tail->sibling != nullptr)
+        {
+          tail = tail->sibling;
+        }
+        tail->sibling = pending;
+        pending       = child;
+      }
+      std::destroy_at(&node->value());
+      delete node;
+    }
+  }
+};
+
+template <typename T, typename Compare = std::less<T>, size_t Arity = 2>
+class IndexedPriorityQueue
+{
+  static_assert(Arity >= 2);
+
+  public:
+  using Handle = size_t;
+
+  static constexpr Handle npos = std::numeric_limits<size_t>::max();
+
+  const T& top() const
+  {
+    return heap.front().value;
+  }
+
+  Handle top_handle() const
+  {
+    return heap.front().handle;
+  }
+
+  bool empty() const
+  {
+    return heap.empty();
+  }
+
+  size_t size() const
+  {
+    return heap.size();
+  }
+
+  //true while the element of handle is in the heap
+  bool contains(Handle handle) const
+  {
+    return handle < position.size() && position[handle] != npos;
+  }
+
+  const T& value(Handle handle) const
+  {
+    assert(contains(handle));
+    return heap[position[handle]].value;
+  }
+
+  //the returned handle names this element until it is popped or erased. Handles are then reused: a later push
+  //may return the same number for a new element, so a stale handle silently refers to that element and
+  //contains() is true for it again. Drop (or mark) a handle as soon as its element leaves the heap.
+  Handle push(T value)
+  {
+    Handle handle;
+    if(free_handles.empty())
+    {
+      handle = position.size();
+      position.push_back(npos);
+    }
+    else
+    {
+      handle = free_handles.back();
+      free_handles.pop_back();
+    }
+    heap.push_back(Entry{std::move(value), handle});
+    position[handle] = heap.size() - 1;
+    sift_up(heap.size() - 1, 0, std::move(heap.back()));
+    return handle;
+  }
+
+  void pop()
+  {
+    if(heap.empty())
     {
       return;
     }
-    std::swap(container.front(), container.back());
-    heapify(0, container.size() - 2, 0);    // reconstruct the heap, excluding the last element
+    erase_at(0);
+  }
+
+  void erase(Handle handle)
+  {
+    assert(contains(handle));
+    erase_at(position[handle]);
+  }
+
+  //value must not compare below the current one: the element can only move toward top
+  void increase_key(Handle handle, T value)
+  {
+    assert(contains(handle) && !compare(value, this->value(handle)));
+    sift_up(position[handle], 0, Entry{std::move(value), handle});
+  }
+
+  //value must not compare above the current one: the element can only move away from top
+  void decrease_key(Handle handle, T value)
+  {
+    assert(contains(handle) && !compare(this->value(handle), value));
+    sift_down(position[handle], Entry{std::move(value), handle});
+  }
+
+  //any new value; picks the direction
+  void update(Handle handle, T value)
+  {
+    assert(contains(handle));
+    refill(position[handle], Entry{std::move(value), handle});
+  }
+
+  private:
+  struct Entry
+  {
+    T      value;
+    Handle handle;
+  };
+
+  std::vector<Entry, SiblingAlignedAllocator<Entry>> heap;
+  std::vector<size_t>                                position;        // handle -> heap index, npos when free
+  std::vector<Handle>                                free_handles;    // handles to hand out again
+  Compare                                            compare;
+
+  //every entry that lands somewhere goes through here, so the position map never goes stale
+  void place(size_t index, Entry&& entry)
+  {
+    position[entry.handle] = index;
+    heap[index]            = std::move(entry);
+  }
+
+  //same hole-based sifts as PriorityQueue, recording each moved entry
+  void sift_down(size_t index, Entry entry)
+  {
+    const size_t size  = heap.size();
+    const size_t start = index;
+    while(true)
+    {
+      const size_t first = Arity * index + 1;
+      if(first >= size)
+      {
+        break;
+      }
+      const size_t last = std::min(first + Arity, size);
+      size_t       best = first;
+      for(size_t child = first + 1; child < last; child++)
+      {
+        best = compare(heap[best].value, heap[child].value) ? child : best;
+      }
+      place(index, std::move(heap[best]));
+      index = best;
+    }
+    sift_up(index, start, std::move(entry));
   }
 
-  void push_heap(size_t first, size_t last)
+  void sift_up(size_t index, size_t top, Entry entry)
   {
-    auto index  = last;
-    auto parent = first + (last - 1) / 2;
+    while(index > top)
+    {
+      const size_t parent = (index - 1) / Arity;
+      if(!compare(heap[parent].value, entry.value))
+      {
+        break;
+      }
+      place(index, std::move(heap[parent]));
+      index = parent;
+    }
+    place(index, std::move(entry));
+  }
 
-    while(index > first && compare(container[parent], container[index]))
+  //fills the hole at index with entry, sifting whichever way it has to go
+  void refill(size_t index, Entry entry)
+  {
+    if(index > 0 && compare(heap[(index - 1) / Arity].value, entry.value))
+    {
+      sift_up(index, 0, std::move(entry));
+    }
+    else
     {
-      std::swap(container[index], container[parent]);
-      index  = parent;
-      parent = first + (index - 1) / 2;
+      sift_down(index, std::move(entry));
+    }
+  }
+
+  //the last entry fills the hole left at index; the removed handle is freed
+  void erase_at(size_t index)
+  {
+    const Handle handle = heap[index].handle;
+    Entry        last   = std::move(heap.back());
+    heap.pop_back();
+    position[handle] = npos;
+    free_handles.push_back(handle);
+    if(index < heap.size())
+    {
+      refill(index, std::move(last));
     }
   }
 };
 
-int main()
+// ns per operation on 1M 64-bit deadlines: push all then pop all, and a "hold" mix where every step pops
+// the earliest deadline and pushes a later one, as a timer queue does
+template <typename Heap>
+void benchmark_heap(const char* name, const std::vector<uint64_t>& keys)
+{
+  const size_t n    = keys.size();
+  uint64_t     sink = 0;
+
+  auto time = [&](auto body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / n;
+  };
+
+  Heap         heap;
+  const double push_ns = time([&] {
+    for(uint64_t key : keys)
+      heap.push(key);
+  });
+  const double pop_ns = time([&] {
+    for(size_t i = 0; i < n; i++)
+    {
+      sink += heap.top();
+      heap.pop();
+    }
+  });
+
+  for(uint64_t key : keys)
+    heap.push(key);
+  const double hold_ns = time([&] {
+    for(size_t i = 0; i < n; i++)
+    {
+      const uint64_t earliest = heap.top();
+      heap.pop();
+      heap.push(earliest + keys[i] % 4096);
+    }
+  });
+
+  std::cout << name << "\t" << push_ns << "\t" << pop_ns << "\t" << hold_ns << "\t(" << sink % 10 << ")"
+            << std::endl;
+}
+
+void benchmark_priority_queue()
+{
+  constexpr size_t n = size_t(1) << 20;
+
+  std::mt19937_64       rng(1);
+  std::vector<uint64_t> keys(n);
+  for(uint64_t& key : keys)
+    key = rng() >> 16;
+
+  using Earliest = std::greater<uint64_t>;    // a min-heap of deadlines
+  using Storage  = std::vector<uint64_t, SiblingAlignedAllocator<uint64_t>>;
+
+  std::cout << "heap\t\t\tpush\tpop\thold (ns/op)" << std::endl;
+  benchmark_heap<std::priority_queue<uint64_t, std::vector<uint64_t>, Earliest>>("std::priority_queue", keys);
+  benchmark_heap<PriorityQueue<uint64_t, Storage, Earliest, 2>>("PriorityQueue 2-ary", keys);
+  benchmark_heap<PriorityQueue<uint64_t, Storage, Earliest, 4>>("PriorityQueue 4-ary", keys);
+  benchmark_heap<PriorityQueue<uint64_t, Storage, Earliest, 8>>("PriorityQueue 8-ary", keys);
+  benchmark_heap<PairingHeap<uint64_t, Earliest>>("PairingHeap\t", keys);
+
+  // building 1024 heaps of 1024 deadlines and merging them into one; the array heaps merge the fair way,
+  // by concatenating their storage and running make_heap once over the result
+  constexpr size_t parts = 1024;
+  constexpr size_t part  = n / parts;
+  uint64_t         sink  = 0;
+  auto             start = std::chrono::steady_clock::now();
+  {
+    std::vector<Storage> heaps(parts);
+    for(size_t p = 0; p < parts; p++)
+    {
+      heaps[p].assign(keys.begin() + p * part, keys.begin() + (p + 1) * part);
+      std::make_heap(heaps[p].begin(), heaps[p].end(), Earliest());
+    }
+    Storage merged;
+    merged.reserve(n);
+    for(const Storage& heap : heaps)
+      merged.insert(merged.end(), heap.begin(), heap.end());
+    PriorityQueue<uint64_t, Storage, Earliest, 4> all(merged.begin(), merged.end());
+    sink += all.top();
+  }
+  std::chrono::duration<double, std::micro> array_us = std::chrono::steady_clock::now() - start;
+  start                                              = std::chrono::steady_clock::now();
+  {
+    PairingHeap<uint64_t, Earliest> all;
+    for(size_t p = 0; p < parts; p++)
+    {
+      PairingHeap<uint64_t, Earliest> heap;
+      for(size_t i = p * part; i < (p + 1) * part; i++)
+        heap.push(keys[i]);
+      all.merge(heap);
+    }
+    sink += all.top();
+  }
+  std::chrono::duration<double, std::micro> pairing_us = std::chrono::steady_clock::now() - start;
+  std::cout << "build + merge " << parts << " heaps: 4-ary (concatenate + make_heap) " << array_us.count()
+            << " us, pairing (merge) " << pairing_us.count() << " us\t(" << sink % 10 << ")" << std::endl;
+}
+
+// Dijkstra on a random graph: lazy deletion (push duplicates, skip stale pops) against an indexed heap
+// that updates a vertex's entry in place; reports ms and the largest heap size reached
+void benchmark_indexed_priority_queue()
+{
+  constexpr uint32_t vertices = uint32_t(1) << 18;
+  constexpr uint32_t degree   = 8;
+  constexpr uint64_t infinity = std::numeric_limits<uint64_t>::max();
+
+  struct Edge
+  {
+    uint32_t to;
+    uint32_t weight;
+  };
+
+  std::mt19937      rng(1);
+  std::vector<Edge> edges(size_t(vertices) * degree);
+  for(Edge& edge : edges)
+    edge = Edge{static_cast<uint32_t>(rng() % vertices), static_cast<uint32_t>(1 + rng() % 1000)};
+
+  using Item     = std::pair<uint64_t, uint32_t>;    // distance, vertex
+  using Earliest = std::greater<Item>;
+
+  auto time = [](auto body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+  };
+
+  std::vector<uint64_t> lazy_dist(vertices, infinity);
+  size_t                lazy_peak = 0;
+  const double          lazy_ms   = time([&] {
+    PriorityQueue<Item, std::vector<Item, SiblingAlignedAllocator<Item>>, Earliest, 4> queue;
+    lazy_dist[0] = 0;
+    queue.push(Item{0, 0});
+    while(!queue.empty())
+    {
+      const auto [dist, u] = queue.top();
+      queue.pop();
+      if(dist > lazy_dist[u])
+        continue;    // stale duplicate
+      for(uint32_t e = u * degree; e < (u + 1) * degree; e++)
+      {
+        const uint64_t candidate = dist + edges[e].weight;
+        if(candidate < lazy_dist[edges[e].to])
+        {
+          lazy_dist[edges[e].to] = candidate;
+          queue.push(Item{candidate, edges[e].to});
+          lazy_peak = std::max(lazy_peak, queue.size());
+        }
+      }
+    }
+  });
+
+  using Indexed = IndexedPriorityQueue<Item, Earliest, 4>;
+  std::vector<uint64_t>        indexed_dist(vertices, infinity);
+  std::vector<Indexed::Handle> handles(vertices, Indexed::npos);
+  size_t                       indexed_peak = 0;
+  const double                 indexed_ms   = time([&] {
+    Indexed queue;
+    indexed_dist[0] = 0;
+    handles[0]      = queue.push(Item{0, 0});
+    while(!queue.empty())
+    {
+      const auto [dist, u] = queue.top();
+      queue.pop();
+      handles[u] = Indexed::npos;
+      for(uint32_t e = u * degree; e < (u + 1) * degree; e++)
+      {
+        const uint32_t v         = edges[e].to;
+        const uint64_t candidate = dist + edges[e].weight;
+        if(candidate < indexed_dist[v])
+        {
+          indexed_dist[v] = candidate;
+          if(handles[v] == Indexed::npos)
+            handles[v] = queue.push(Item{candidate, v});
+          else
+            queue.increase_key(handles[v], Item{candidate, v});    // closer means nearer the top
+          indexed_peak = std::max(indexed_peak, queue.size());
+        }
+      }
+    }
+  });
+
+  std::cout << "dijkstra " << vertices << " vertices\tms\tpeak heap size" << std::endl;
+  std::cout << "lazy deletion\t\t" << lazy_ms << "\t" << lazy_peak << std::endl;
+  std::cout << "indexed\t\t\t" << indexed_ms << "\t" << indexed_peak
+            << (lazy_dist == indexed_dist ? "" : "\t(distances differ!)") << std::endl;
+}
+
+int main(int argc, char** argv)
 {
     PriorityQueue<int> pq;
     pq.push(10);
@@ -126,5 +850,33 @@ int main()
     std::cout << pq.top() << std::endl;  // Output: 15
     pq.pop();
     std::cout << pq.top() << std::endl;  // Output: 10
+
+    PriorityQueue<int, std::vector<int>, std::less<int>, 4> wide;
+    PairingHeap<int>                                        pairing, other;
+    for(int value : {7, 3, 9, 1})
+    {
+      wide.push(value);
+      pairing.push(value);
+      other.push(value * 10);
+    }
+    pairing.merge(other);
+    std::cout << wide.top() << std::endl;     // Output: 9
+    std::cout << pairing.top() << std::endl;  // Output: 90
+
+    IndexedPriorityQueue<int> indexed;
+    auto                      low  = indexed.push(5);
+    auto                      high = indexed.push(50);
+    indexed.push(25);
+    indexed.increase_key(low, 75);
+    indexed.erase(high);
+    std::cout << indexed.top() << std::endl;  // Output: 75
+    indexed.update(low, 1);
+    std::cout << indexed.top() << std::endl;  // Output: 25
+
+    if(argc > 1 && std::string_view(argv[1]) == "--bench")
+    {
+      benchmark_priority_queue();
+      benchmark_indexed_priority_queue();
+    }
   return 0;
-}
\ No newline at end of file
+}
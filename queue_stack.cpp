@@ -1,7 +1,282 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <deque>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
 
-template <typename T, typename Container = std::deque<T>>
+/**
+ * RingBuffer: growable circular array, the default Container of Queue and Stack
+ *
+ * layout:
+ * one allocation of capacity slots (zero or a power of two); element i sits at slot (head + i) & (capacity - 1),
+ * so both ends push and pop in O(1) without moving anything and a drained queue keeps its storage.
+ *
+ * growth:
+ * a push into a full buffer doubles the capacity (at least 8), constructs the new element in the new storage
+ * first (so pushing one of the buffer's own elements is safe), then moves the old elements over unrolled to
+ * start at slot 0; a throwing copy leaves the buffer untouched.
+ *
+ * against std::deque: one contiguous block instead of a map of fixed-size chunks, no chunk allocation while a
+ * queue cycles, and at most capacity - size spare slots instead of per-chunk slack plus the map.
+ */
+template <typename T>
+class RingBuffer
+{
+  public:
+  using value_type      = T;
+  using size_type       = size_t;
+  using reference       = T&;
+  using const_reference = const T&;
+
+  RingBuffer() = default;
+
+  // delegating makes the object complete before the copies start, so a throwing copy runs ~RingBuffer
+  RingBuffer(const RingBuffer& other) : RingBuffer()
+  {
+    reserve(other.size_);
+    for(size_t i = 0; i < other.size_; i++)
+    {
+      push_back(other[i]);
+    }
+  }
+
+  RingBuffer(RingBuffer&& other) noexcept
+      : data(std::exchange(other.data, nullptr)),
+        capacity_(std::exchange(other.capacity_, 0)),
+        head(std::exchange(other.head, 0)),
+        size_(std::exchange(other.size_, 0))
+  {
+  }
+
+  RingBuffer& operator=(RingBuffer other) noexcept
+  {
+    std::swap(data, other.data);
+    std::swap(capacity_, other.capacity_);
+    std::swap(head, other.head);
+    std::swap(size_, other.size_);
+    return *this;
+  }
+
+  ~RingBuffer()
+  {
+    clear();
+    std::allocator<T>().deallocate(data, capacity_);
+  }
+
+  T& operator[](size_t index)
+  {
+    return *slot(index);
+  }
+
+  const T& operator[](size_t index) const
+  {
+    return *slot(index);
+  }
+
+  T& front()
+  {
+    return *slot(0);
+  }
+
+  T& back()
+  {
+    return *slot(size_ - 1);
+  }
+
+  bool empty() const
+  {
+    return size_ == 0;
+  }
+
+  size_t size() const
+  {
+    return size_;
+  }
+
+  size_t capacity() const
+  {
+    return capacity_;
+  }
+
+  void push_back(const T& value)
+  {
+    emplace_back(value);
+  }
+
+  void push_back(T&& value)
+  {
+    emplace_back(std::move(value));
+  }
+
+  template <typename... Args>
+  T& emplace_back(Args&&... args)
+  {
+    if(size_ == capacity_)
+    {
+      grow(size_, std::forward<Args>(args)...);
+    }
+    else
+    {
+      std::construct_at(slot(size_), std::forward<Args>(args)...);
+    }
+    size_++;
+    return back();
+  }
+
+  void push_front(const T& value)
+  {
+    emplace_front(value);
+  }
+
+  void push_front(T&& value)
+  {
+    emplace_front(std::move(value));
+  }
+
+  template <typename... Args>
+  T& emplace_front(Args&&... args)
+  {
+    if(size_ == capacity_)
+    {
+      grow(next_capacity() - 1, std::forward<Args>(args)...);
+      head = capacity_ - 1;
+    }
+    else
+    {
+      const size_t position = (head - 1) & (capacity_ - 1);
+      std::construct_at(&data[position], std::forward<Args>(args)...);
+      head = position;
+    }
+    size_++;
+    return front();
+  }
+
+  void pop_front()
+  {
+    std::destroy_at(slot(0));
+    head = (head + 1) & (capacity_ - 1);
+    size_--;
+  }
+
+  void pop_back()
+  {
+    std::destroy_at(slot(size_ - 1));
+    size_--;
+  }
+
+  void clear()
+  {
+    while(size_ > 0)
+    {
+      pop_back();
+    }
+    head = 0;
+  }
+
+  void reserve(size_t count)
+  {
+    if(count <= capacity_)
+    {
+      return;
+    }
+    const size_t new_capacity = std::bit_ceil(count);
+    T*           fresh        = std::allocator<T>().allocate(new_capacity);
+    try
+    {
+      move_to(fresh, new_capacity);
+    }
+    catch(...)
+    {
+      std::allocator<T>().deallocate(fresh, new_capacity);
+      throw;
+    }
+  }
+
+  private:
+  T* slot(size_t index) const
+  {
+    return &data[(head + index) & (capacity_ - 1)];
+  }
+
+  size_t next_capacity() const
+  {
+    return capacity_ == 0 ? 8 : capacity_ * 2;
+  }
+
+  // builds the new element at position of a doubled buffer, then moves the old elements over
+  template <typename... Args>
+  void grow(size_t position, Args&&... args)
+  {
+    const size_t new_capacity = next_capacity();
+    T*           fresh        = std::allocator<T>().allocate(new_capacity);
+    try
+    {
+      std::construct_at(fresh + position, std::forward<Args>(args)...);
+    }
+    catch(...)
+    {
+      std::allocator<T>().deallocate(fresh, new_capacity);
+      throw;
+    }
+    try
+    {
+      move_to(fresh, new_capacity);
+    }
+    catch(...)
+    {
+      std::destroy_at(fresh + position);
+      std::allocator<T>().deallocate(fresh, new_capacity);
+      throw;
+    }
+  }
+
+  // moves the elements to fresh[0, size) and adopts it; on a throwing copy only fresh's elements are undone
+  void move_to(T* fresh, size_t new_capacity)
+  {
+    size_t moved = 0;
+    try
+    {
+      for(; moved < size_; moved++)
+      {
+        std::construct_at(fresh + moved, std::move_if_noexcept(*slot(moved)));
+      }
+    }
+    catch(...)
+    {
+      std::destroy_n(fresh, moved);
+      throw;
+    }
+    for(size_t i = 0; i < size_; i++)
+    {
+      std::destroy_at(slot(i));
+    }
+    std::allocator<T>().deallocate(data, capacity_);
+    data      = fresh;
+    capacity_ = new_capacity;
+    head      = 0;
+  }
+
+  T*     data      = nullptr;
+  size_t capacity_ = 0;    // zero or a power of two
+  size_t head      = 0;    // slot of element 0
+  size_t size_     = 0;
+};
+
+template <typename T, typename Container = RingBuffer<T>>
 class Queue
 {
   public:
@@ -31,11 +306,17 @@ class Queue
     container.push_back(value);
   }
 
-  void push(const T&& value)
+  void push(T&& value)
   {
     container.push_back(std::move(value));
   }
 
+  template <typename... Args>
+  T& emplace(Args&&... args)
+  {
+    return container.emplace_back(std::forward<Args>(args)...);
+  }
+
   void pop()
   {
     container.pop_front();
@@ -45,7 +326,7 @@ class Queue
   Container container;
 };
 
-template <typename T, typename Container = std::deque<T>>
+template <typename T, typename Container = RingBuffer<T>>
 class Stack
 {
   public:
@@ -70,11 +351,17 @@ class Stack
     container.push_back(value);
   }
 
-  void push(const T&& value)
+  void push(T&& value)
   {
     container.push_back(std::move(value));
   }
 
+  template <typename... Args>
+  T& emplace(Args&&... args)
+  {
+    return container.emplace_back(std::forward<Args>(args)...);
+  }
+
   void pop()
   {
     container.pop_back();
@@ -84,7 +371,1218 @@ class Stack
   Container container;
 };
 
-int main()
+/**
+ * SpscQueue: bounded ring buffer for exactly one producer thread and one consumer thread
+ *
+ * layout:
+ * head and tail are free-running counters, slot i lives at slots[i & (Capacity - 1)], so a full queue
+ * (tail - head == Capacity) and an empty one (tail == head) need no spare slot.
+ * the producer owns tail, the consumer owns head; each sits on its own cache line together with that
+ * side's cached copy of the other index, so the two threads only share a line when a cache runs out.
+ *
+ * synchronization:
+ * 1. the producer constructs the element, then publishes it with a release store of tail;
+ *    the consumer's acquire load of tail makes the element visible before it reads it
+ * 2. the consumer destroys the element, then hands the slot back with a release store of head
+ * 3. try_push and try_pop only reload the other side's index when the cached one says full or empty,
+ *    and never wait: both are wait-free
+ * 4. push_n and pop_n move a whole batch with a single index publish
+ * 5. push and pop keep the shape of Queue; push yields until there is room, front and pop expect
+ *    the consumer to have seen !empty()
+ */
+constexpr size_t cache_line = 64;
+
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+  public:
+  SpscQueue() : slots(std::allocator<T>().allocate(Capacity)) {}
+
+  SpscQueue(const SpscQueue&)            = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  ~SpscQueue()
+  {
+    const size_t last = tail.load(std::memory_order_relaxed);
+    for(size_t i = head.load(std::memory_order_relaxed); i != last; i++)
+    {
+      std::destroy_at(&slots[i & mask]);
+    }
+    std::allocator<T>().deallocate(slots, Capacity);
+  }
+
+  // producer only
+  bool try_push(const T& value)
+  {
+    return try_emplace(value);
+  }
+
+  bool try_push(T&& value)
+  {
+    return try_emplace(std::move(value));
+  }
+
+  // producer only; constructs in place, args are untouched when the queue is full
+  template <typename... Args>
+  bool try_emplace(Args&&... args)
+  {
+    const size_t position = tail.load(std::memory_order_relaxed);
+    if(position - cached_head == Capacity)
+    {
+      cached_head = head.load(std::memory_order_acquire);
+      if(position - cached_head == Capacity)
+      {
+        return false;
+      }
+    }
+    std::construct_at(&slots[position & mask], std::forward<Args>(args)...);
+    tail.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  // consumer only
+  bool try_pop(T& out)
+  {
+    const size_t position = head.load(std::memory_order_relaxed);
+    if(position == cached_tail)
+    {
+      cached_tail = tail.load(std::memory_order_acquire);
+      if(position == cached_tail)
+      {
+        return false;
+      }
+    }
+    T& slot = slots[position & mask];
+    out     = std::move(slot);
+    std::destroy_at(&slot);
+    head.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  // producer only; pushes up to count elements from first, returns how many went in;
+  // a throwing copy leaves the queue as it was
+  template <typename InputIt>
+  size_t push_n(InputIt first, size_t count)
+  {
+    const size_t position = tail.load(std::memory_order_relaxed);
+    if(Capacity - (position - cached_head) < count)
+    {
+      cached_head = head.load(std::memory_order_acquire);
+    }
+    const size_t n = std::min(count, Capacity - (position - cached_head));
+    size_t       i = 0;
+    try
+    {
+      for(; i < n; i++, ++first)
+      {
+        std::construct_at(&slots[(position + i) & mask], *first);
+      }
+    }
+    catch(...)
+    {
+      for(size_t built = 0; built < i; built++)
+      {
+        std::destroy_at(&slots[(position + built) & mask]);
+      }
+      throw;
+    }
+    tail.store(position + n, std::memory_order_release);
+    return n;
+  }
+
+  // consumer only; moves up to count elements to out, returns how many came out
+  template <typename OutputIt>
+  size_t pop_n(OutputIt out, size_t count)
+  {
+    const size_t position = head.load(std::memory_order_relaxed);
+    if(cached_tail - position < count)
+    {
+      cached_tail = tail.load(std::memory_order_acquire);
+    }
+    const size_t n = std::min(count, cached_tail - position);
+    for(size_t i = 0; i < n; i++, ++out)
+    {
+      T& slot = slots[(position + i) & mask];
+      *out    = std::move(slot);
+      std::destroy_at(&slot);
+    }
+    head.store(position + n, std::memory_order_release);
+    return n;
+  }
+
+  // producer only; yields until there is room
+  void push(const T& value)
+  {
+    while(!try_emplace(value))
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  void push(T&& value)
+  {
+    while(!try_emplace(std::move(value)))
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  // consumer only, after it has seen !empty()
+  T& front()
+  {
+    return slots[head.load(std::memory_order_relaxed) & mask];
+  }
+
+  void pop()
+  {
+    const size_t position = head.load(std::memory_order_relaxed);
+    std::destroy_at(&slots[position & mask]);
+    head.store(position + 1, std::memory_order_release);
+  }
+
+  bool empty() const
+  {
+    return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+  }
+
+  // exact from either end, a snapshot from any other thread; head is read first so it never exceeds tail
+  size_t size() const
+  {
+    const size_t first = head.load(std::memory_order_acquire);
+    return tail.load(std::memory_order_acquire) - first;
+  }
+
+  static constexpr size_t capacity()
+  {
+    return Capacity;
+  }
+
+  private:
+  static constexpr size_t mask = Capacity - 1;
+
+  alignas(cache_line) std::atomic<size_t> tail{0};
+  size_t cached_head = 0;    // producer's last view of head
+
+  alignas(cache_line) std::atomic<size_t> head{0};
+  size_t cached_tail = 0;    // consumer's last view of tail
+
+  alignas(cache_line) T* const slots;
+};
+
+/**
+ * MpmcQueue: bounded array queue for any number of producer and consumer threads (Vyukov's design)
+ *
+ * layout:
+ * capacity is rounded up to a power of two; every cell carries a sequence number next to its storage.
+ * enqueue_pos and dequeue_pos are free-running counters on cache lines of their own.
+ *
+ * cell protocol, for position pos and its cell at pos & mask:
+ * 1. sequence == pos: the cell is free for the producer of pos; it claims pos with a CAS on
+ *    enqueue_pos, constructs the element and stores sequence = pos + 1 (release)
+ * 2. sequence == pos + 1: the cell holds the element for the consumer of pos; it claims pos with a
+ *    CAS on dequeue_pos, moves the element out and stores sequence = pos + capacity, which is the
+ *    free state for the producer one lap later
+ * 3. a sequence behind those values means full (for try_push) or empty (for try_pop); one ahead means
+ *    another thread claimed pos first, so reload the counter and retry
+ *
+ * blocking:
+ * push and pop retry for spin_limit rounds, then yield_limit times giving up the core, then park on an
+ * epoch counter with std::atomic::wait.
+ * the other side bumps the epoch and notifies only when a sleeper count says somebody is parked;
+ * a seq_cst fence on both sides orders "publish the cell, read the sleeper count" against
+ * "raise the sleeper count, re-check the cell", so no wakeup is lost.
+ *
+ * batching:
+ * pop_bulk counts how many consecutive cells from dequeue_pos are ready and claims all of them with
+ * one CAS, so a batch pays for one contended atomic instead of one per element
+ *
+ * exceptions:
+ * a claimed cell must always be published, or every later thread reaching its position waits forever.
+ * -- T must be nothrow move constructible; an element whose construction from the arguments may throw
+ *    is built before a cell is claimed and then moved in
+ * -- a consumer whose move out of the cell throws still destroys the element and frees the cell;
+ *    if pop_bulk's output throws, the rest of the claimed batch is destroyed as well, then it rethrows
+ */
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#endif
+}
+
+template <typename T>
+class MpmcQueue
+{
+  static_assert(std::is_nothrow_move_constructible_v<T>, "a claimed cell must not be left unpublished");
+
+  public:
+  explicit MpmcQueue(size_t capacity)
+      : mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1), cells(std::make_unique<Cell[]>(mask + 1))
+  {
+    for(size_t i = 0; i <= mask; i++)
+    {
+      cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpmcQueue(const MpmcQueue&)            = delete;
+  MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+  ~MpmcQueue()
+  {
+    const size_t last = enqueue_pos.load(std::memory_order_relaxed);
+    for(size_t pos = dequeue_pos.load(std::memory_order_relaxed); pos != last; pos++)
+    {
+      std::destroy_at(cells[pos & mask].value());
+    }
+  }
+
+  bool try_push(const T& value)
+  {
+    return try_emplace(value);
+  }
+
+  bool try_push(T&& value)
+  {
+    return try_emplace(std::move(value));
+  }
+
+  // args are untouched when the queue is full, unless constructing T from them may throw:
+  // then the element is built before claiming a cell and is lost when the queue is full
+  template <typename... Args>
+  bool try_emplace(Args&&... args)
+  {
+    if constexpr(!std::is_nothrow_constructible_v<T, Args...>)
+    {
+      return try_emplace(T(std::forward<Args>(args)...));
+    }
+    size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    Cell*  cell;
+    while(true)
+    {
+      cell                 = &cells[pos & mask];
+      const size_t   seq   = cell->sequence.load(std::memory_order_acquire);
+      const intptr_t delta = static_cast<intptr_t>(seq - pos);
+      if(delta == 0)
+      {
+        if(enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          break;
+        }
+      }
+      else if(delta < 0)
+      {
+        return false;
+      }
+      else
+      {
+        pos = enqueue_pos.load(std::memory_order_relaxed);
+      }
+    }
+    std::construct_at(cell->value(), std::forward<Args>(args)...);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    wake(pushed, sleeping_consumers);
+    return true;
+  }
+
+  bool try_pop(T& out)
+  {
+    return try_take([&](T&& value) { out = std::move(value); });
+  }
+
+  // moves up to max ready elements to out with a single claim; returns how many, 0 when empty
+  template <typename OutputIt>
+  size_t pop_bulk(OutputIt out, size_t max)
+  {
+    if(max == 0)
+    {
+      return 0;    // nothing to claim; the empty check below would otherwise retry forever
+    }
+    size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+    size_t count;
+    while(true)
+    {
+      count = 0;
+      while(count < max && count <= mask
+            && cells[(pos + count) & mask].sequence.load(std::memory_order_acquire) == pos + count + 1)
+      {
+        count++;
+      }
+      if(count == 0)
+      {
+        const size_t   seq   = cells[pos & mask].sequence.load(std::memory_order_acquire);
+        const intptr_t delta = static_cast<intptr_t>(seq - (pos + 1));
+        if(delta < 0)
+        {
+          return 0;
+        }
+        pos = dequeue_pos.load(std::memory_order_relaxed);
+        continue;
+      }
+      if(dequeue_pos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+      {
+        break;
+      }
+    }
+    size_t i = 0;
+    try
+    {
+      for(; i < count; i++, ++out)
+      {
+        release(cells[(pos + i) & mask], pos + i, [&](T&& value) { *out = std::move(value); });
+      }
+    }
+    catch(...)
+    {
+      // cell i is already freed by release; the rest of the batch is dropped so no cell stays claimed
+      for(i++; i < count; i++)
+      {
+        release(cells[(pos + i) & mask], pos + i, [](T&&) {});
+      }
+      wake(popped, sleeping_producers);
+      throw;
+    }
+    wake(popped, sleeping_producers);
+    return count;
+  }
+
+  // spins, then parks until there is room
+  void push(const T& value)
+  {
+    wait_until(popped, sleeping_producers, [&] { return try_emplace(value); });
+  }
+
+  void push(T&& value)
+  {
+    wait_until(popped, sleeping_producers, [&] { return try_emplace(std::move(value)); });
+  }
+
+  // spins, then parks until there is an element
+  T pop()
+  {
+    std::optional<T> out;
+    wait_until(pushed, sleeping_consumers,
+               [&] { return try_take([&](T&& value) { out.emplace(std::move(value)); }); });
+    return std::move(*out);
+  }
+
+  // a snapshot; exact only while no other thread is pushing or popping
+  size_t size() const
+  {
+    const size_t first = dequeue_pos.load(std::memory_order_acquire);
+    return enqueue_pos.load(std::memory_order_acquire) - first;
+  }
+
+  bool empty() const
+  {
+    return size() == 0;
+  }
+
+  size_t capacity() const
+  {
+    return mask + 1;
+  }
+
+  private:
+  static constexpr int spin_limit  = 128;
+  static constexpr int yield_limit = 16;
+
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    T* value()
+    {
+      return std::launder(reinterpret_cast<T*>(storage));
+    }
+  };
+
+  // claims the next element and hands it to take as an rvalue
+  template <typename Take>
+  bool try_take(Take take)
+  {
+    size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+    Cell*  cell;
+    while(true)
+    {
+      cell                 = &cells[pos & mask];
+      const size_t   seq   = cell->sequence.load(std::memory_order_acquire);
+      const intptr_t delta = static_cast<intptr_t>(seq - (pos + 1));
+      if(delta == 0)
+      {
+        if(dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          break;
+        }
+      }
+      else if(delta < 0)
+      {
+        return false;
+      }
+      else
+      {
+        pos = dequeue_pos.load(std::memory_order_relaxed);
+      }
+    }
+    try
+    {
+      release(*cell, pos, take);
+    }
+    catch(...)
+    {
+      wake(popped, sleeping_producers);    // the cell was freed all the same
+      throw;
+    }
+    wake(popped, sleeping_producers);
+    return true;
+  }
+
+  // hands the element to take, then destroys it and frees the cell for the next lap, even if take throws
+  template <typename Take>
+  void release(Cell& cell, size_t pos, Take take)
+  {
+    T* value = cell.value();
+    try
+    {
+      take(std::move(*value));
+    }
+    catch(...)
+    {
+      std::destroy_at(value);
+      cell.sequence.store(pos + mask + 1, std::memory_order_release);
+      throw;
+    }
+    std::destroy_at(value);
+    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+  }
+
+  // called after publishing a cell: wake the other side only if somebody is parked
+  static void wake(std::atomic<uint32_t>& epoch, std::atomic<uint32_t>& sleepers)
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(sleepers.load(std::memory_order_relaxed) != 0)
+    {
+      epoch.fetch_add(1, std::memory_order_release);
+      epoch.notify_all();
+    }
+  }
+
+  template <typename Attempt>
+  static void wait_until(std::atomic<uint32_t>& epoch, std::atomic<uint32_t>& sleepers, Attempt attempt)
+  {
+    for(int spin = 0; spin < spin_limit; spin++)
+    {
+      if(attempt())
+      {
+        return;
+      }
+      cpu_relax();
+    }
+    for(int round = 0; round < yield_limit; round++)
+    {
+      if(attempt())
+      {
+        return;
+      }
+      std::this_thread::yield();
+    }
+    while(true)
+    {
+      sleepers.fetch_add(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      const uint32_t seen = epoch.load(std::memory_order_acquire);
+      if(attempt())
+      {
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+        return;
+      }
+      epoch.wait(seen, std::memory_order_acquire);
+      sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+
+  const size_t            mask;
+  std::unique_ptr<Cell[]> cells;
+
+  alignas(cache_line) std::atomic<size_t> enqueue_pos{0};
+  alignas(cache_line) std::atomic<size_t> dequeue_pos{0};
+
+  // parked consumers wait on pushed, parked producers on popped
+  alignas(cache_line) std::atomic<uint32_t> pushed{0};
+  std::atomic<uint32_t>                     popped{0};
+  std::atomic<uint32_t>                     sleeping_consumers{0};
+  std::atomic<uint32_t>                     sleeping_producers{0};
+};
+
+/**
+ * ConcurrentStack: unbounded lock-free Treiber stack
+ *
+ * layout:
+ * elements live in nodes linked from top; top is one 64-bit word holding the node address in the low
+ * 48 bits and a modification count in the high 16 bits, so it is updated with a single plain CAS.
+ *
+ * ABA and reclamation:
+ * 1. every successful CAS on a list top bumps its count, so a pop that read top, stalled while the node
+ *    was popped and pushed back, and then retries its CAS fails instead of installing a stale next
+ * 2. popped nodes are never freed while the stack lives: they go to a second Treiber list of spare
+ *    nodes and are reused by later pushes, so a stalled pop can still read node->next safely
+ *    (next is atomic for that reason); nodes are freed by the destructor
+ * 3. the 16-bit count can in principle wrap while one thread is stalled for 65536 updates;
+ *    that is the usual trade for not needing a double-width CAS
+ * 4. node addresses must fit in 48 bits (4-level paging, no pointer tagging); 5-level paging (LA57) or
+ *    tagged heap pointers break the packing, which pack() asserts
+ *
+ * elimination backoff (EliminationSlots > 0):
+ * a push whose CAS on top fails offers its node in a random slot and waits a few spins; a pop whose CAS
+ * fails looks at a random slot and takes an offered node. a matched pair completes without touching top.
+ * only the offering push resets its slot, so a slot cannot be re-offered while the push still watches it.
+ */
+template <typename T, size_t EliminationSlots = 0>
+class ConcurrentStack
+{
+  static_assert(sizeof(uintptr_t) == 8, "tagged pointers need 64-bit addresses");
+
+  public:
+  ConcurrentStack() = default;
+
+  ConcurrentStack(const ConcurrentStack&)            = delete;
+  ConcurrentStack& operator=(const ConcurrentStack&) = delete;
+
+  ~ConcurrentStack()
+  {
+    while(Node* node = items.pop())
+    {
+      std::destroy_at(node->value());
+      delete node;
+    }
+    while(Node* node = spare_nodes.pop())
+    {
+      delete node;
+    }
+  }
+
+  void push(const T& value)
+  {
+    emplace(value);
+  }
+
+  void push(T&& value)
+  {
+    emplace(std::move(value));
+  }
+
+  template <typename... Args>
+  void emplace(Args&&... args)
+  {
+    Node* node = spare_nodes.pop();
+    if(node == nullptr)
+    {
+      node = new Node;
+    }
+    try
+    {
+      std::construct_at(node->value(), std::forward<Args>(args)...);
+    }
+    catch(...)
+    {
+      spare_nodes.push(node);
+      throw;
+    }
+    while(!items.try_push(node))
+    {
+      if constexpr(EliminationSlots > 0)
+      {
+        if(offer(node))
+        {
+          return;
+        }
+      }
+    }
+  }
+
+  bool try_pop(T& out)
+  {
+    Node* node;
+    while(true)
+    {
+      bool contended = false;
+      node           = items.try_pop(contended);
+      if(node != nullptr || !contended)
+      {
+        break;
+      }
+      if constexpr(EliminationSlots > 0)
+      {
+        if((node = take()) != nullptr)
+        {
+          break;
+        }
+      }
+    }
+    if(node == nullptr)
+    {
+      return false;
+    }
+    try
+    {
+      out = std::move(*node->value());
+    }
+    catch(...)
+    {
+      // the node is already off the stack: drop the element rather than leak it and the node
+      std::destroy_at(node->value());
+      spare_nodes.push(node);
+      throw;
+    }
+    std::destroy_at(node->value());
+    spare_nodes.push(node);
+    return true;
+  }
+
+  // a snapshot
+  bool empty() const
+  {
+    return items.empty();
+  }
+
+  private:
+  static constexpr int       elimination_spins = 64;
+  static constexpr uintptr_t taken             = 1;    // slot state after a pop took the offered node
+
+  struct Node
+  {
+    std::atomic<Node*> next{nullptr};
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    T* value()
+    {
+      return std::launder(reinterpret_cast<T*>(storage));
+    }
+  };
+
+  // a Treiber list of nodes whose top word packs the address with a modification count
+  class NodeList
+  {
+    public:
+    // one CAS attempt
+    bool try_push(Node* node)
+    {
+      uintptr_t old = top.load(std::memory_order_relaxed);
+      node->next.store(address(old), std::memory_order_relaxed);
+      return top.compare_exchange_weak(old, pack(node, old), std::memory_order_release, std::memory_order_relaxed);
+    }
+
+    void push(Node* node)
+    {
+      while(!try_push(node))
+      {
+      }
+    }
+
+    // one CAS attempt; nullptr with contended set when it lost a race, without it when empty
+    Node* try_pop(bool& contended)
+    {
+      uintptr_t old  = top.load(std::memory_order_acquire);
+      Node*     node = address(old);
+      if(node == nullptr)
+      {
+        return nullptr;
+      }
+      Node* next = node->next.load(std::memory_order_relaxed);
+      if(top.compare_exchange_weak(old, pack(next, old), std::memory_order_acquire, std::memory_order_relaxed))
+      {
+        return node;
+      }
+      contended = true;
+      return nullptr;
+    }
+
+    Node* pop()
+    {
+      bool contended;
+      do
+      {
+        contended = false;
+        if(Node* node = try_pop(contended))
+        {
+          return node;
+        }
+      } while(contended);
+      return nullptr;
+    }
+
+    bool empty() const
+    {
+      return address(top.load(std::memory_order_acquire)) == nullptr;
+    }
+
+    private:
+    static constexpr uintptr_t address_mask = (uintptr_t(1) << 48) - 1;
+    static constexpr uintptr_t count_one    = uintptr_t(1) << 48;
+
+    static Node* address(uintptr_t word)
+    {
+      return reinterpret_cast<Node*>(word & address_mask);
+    }
+
+    // node with the count of old plus one
+    static uintptr_t pack(Node* node, uintptr_t old)
+    {
+      assert((reinterpret_cast<uintptr_t>(node) & ~address_mask) == 0);    // the count would clobber it
+      return reinterpret_cast<uintptr_t>(node) | ((old & ~address_mask) + count_one);
+    }
+
+    alignas(cache_line) std::atomic<uintptr_t> top{0};
+  };
+
+  struct alignas(cache_line) Slot
+  {
+    std::atomic<uintptr_t> offer{0};
+  };
+
+  static size_t random_slot()
+  {
+    thread_local uint32_t state = static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state % std::max<size_t>(EliminationSlots, 1);
+  }
+
+  // true when a pop took node out of the slot
+  bool offer(Node* node)
+  {
+    std::atomic<uintptr_t>& slot     = slots[random_slot()].offer;
+    const uintptr_t         offered  = reinterpret_cast<uintptr_t>(node);
+    uintptr_t               expected = 0;
+    if(!slot.compare_exchange_strong(expected, offered, std::memory_order_release, std::memory_order_relaxed))
+    {
+      return false;
+    }
+    for(int spin = 0; spin < elimination_spins && slot.load(std::memory_order_relaxed) == offered; spin++)
+    {
+      cpu_relax();
+    }
+    expected = offered;
+    if(slot.compare_exchange_strong(expected, 0, std::memory_order_relaxed))
+    {
+      return false;
+    }
+    slot.store(0, std::memory_order_relaxed);
+    return true;
+  }
+
+  Node* take()
+  {
+    std::atomic<uintptr_t>& slot    = slots[random_slot()].offer;
+    uintptr_t               offered = slot.load(std::memory_order_relaxed);
+    if(offered == 0 || offered == taken
+       || !slot.compare_exchange_strong(offered, taken, std::memory_order_acquire, std::memory_order_relaxed))
+    {
+      return nullptr;
+    }
+    return reinterpret_cast<Node*>(offered);
+  }
+
+  NodeList items;
+  NodeList spare_nodes;
+  Slot     slots[std::max<size_t>(EliminationSlots, 1)];
+};
+
+// producer/consumer throughput (ns per item) and ping-pong round-trip latency, SpscQueue against a
+// Queue guarded by a mutex
+void benchmark_spsc()
+{
+  constexpr size_t n     = size_t(1) << 20;
+  constexpr size_t trips = size_t(1) << 14;
+  constexpr size_t batch = 64;
+
+  auto time = [](size_t count, auto body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / count;
+  };
+
+  struct LockedQueue
+  {
+    Queue<int> queue;
+    std::mutex mutex;
+
+    void push(int value)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      queue.push(value);
+    }
+
+    int pop()
+    {
+      while(true)
+      {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          if(!queue.empty())
+          {
+            int value = queue.front();
+            queue.pop();
+            return value;
+          }
+        }
+        std::this_thread::yield();
+      }
+    }
+  };
+
+  auto spsc_pop = [](auto& queue) {
+    while(queue.empty())
+    {
+      std::this_thread::yield();
+    }
+    int value = queue.front();
+    queue.pop();
+    return value;
+  };
+
+  size_t sink = 0;
+
+  LockedQueue  locked;
+  const double locked_ns = time(n, [&] {
+    std::thread producer([&] {
+      for(size_t i = 0; i < n; i++)
+        locked.push(static_cast<int>(i));
+    });
+    for(size_t i = 0; i < n; i++)
+      sink += static_cast<size_t>(locked.pop());
+    producer.join();
+  });
+
+  auto         spsc    = std::make_unique<SpscQueue<int, 1024>>();
+  const double spsc_ns = time(n, [&] {
+    std::thread producer([&] {
+      for(size_t i = 0; i < n; i++)
+        spsc->push(static_cast<int>(i));
+    });
+    for(size_t i = 0; i < n; i++)
+      sink += static_cast<size_t>(spsc_pop(*spsc));
+    producer.join();
+  });
+
+  const double batch_ns = time(n, [&] {
+    std::thread producer([&] {
+      int values[batch];
+      for(size_t i = 0; i < n; i += batch)
+      {
+        for(size_t j = 0; j < batch; j++)
+          values[j] = static_cast<int>(i + j);
+        for(size_t done = 0; done < batch; std::this_thread::yield())
+          done += spsc->push_n(values + done, batch - done);
+      }
+    });
+    int values[batch];
+    for(size_t i = 0; i < n;)
+    {
+      const size_t got = spsc->pop_n(values, batch);
+      for(size_t j = 0; j < got; j++)
+        sink += static_cast<size_t>(values[j]);
+      i += got;
+      if(got == 0)
+        std::this_thread::yield();
+    }
+    producer.join();
+  });
+
+  LockedQueue  locked_ping, locked_pong;
+  const double locked_trip_ns = time(trips, [&] {
+    std::thread echo([&] {
+      for(size_t i = 0; i < trips; i++)
+        locked_pong.push(locked_ping.pop());
+    });
+    for(size_t i = 0; i < trips; i++)
+    {
+      locked_ping.push(static_cast<int>(i));
+      sink += static_cast<size_t>(locked_pong.pop());
+    }
+    echo.join();
+  });
+
+  auto         ping         = std::make_unique<SpscQueue<int, 1024>>();
+  auto         pong         = std::make_unique<SpscQueue<int, 1024>>();
+  const double spsc_trip_ns = time(trips, [&] {
+    std::thread echo([&] {
+      for(size_t i = 0; i < trips; i++)
+        pong->push(spsc_pop(*ping));
+    });
+    for(size_t i = 0; i < trips; i++)
+    {
+      ping->push(static_cast<int>(i));
+      sink += static_cast<size_t>(spsc_pop(*pong));
+    }
+    echo.join();
+  });
+
+  std::cout << "queue\t\tthroughput (ns/item)\tround trip (ns)" << std::endl;
+  std::cout << "mutex Queue\t" << locked_ns << "\t\t\t" << locked_trip_ns << std::endl;
+  std::cout << "SpscQueue\t" << spsc_ns << "\t\t\t" << spsc_trip_ns << std::endl;
+  std::cout << "push_n/pop_n\t" << batch_ns << "\t\t\t-\t(" << sink % 10 << ")" << std::endl;
+}
+
+// ns per item through one queue for several producer/consumer counts, with blocking pop and with pop_bulk
+void benchmark_mpmc()
+{
+  constexpr size_t n     = size_t(1) << 20;
+  constexpr size_t batch = 32;
+
+  auto run = [&](size_t producers, size_t consumers, bool bulk) {
+    MpmcQueue<int>           queue(1024);
+    std::atomic<size_t>      sink{0};
+    std::vector<std::thread> threads;
+    auto                     start = std::chrono::steady_clock::now();
+    for(size_t p = 0; p < producers; p++)
+    {
+      threads.emplace_back([&, p] {
+        for(size_t i = p; i < n; i += producers)
+          queue.push(static_cast<int>(i));
+      });
+    }
+    for(size_t c = 0; c < consumers; c++)
+    {
+      threads.emplace_back([&, c] {
+        size_t share = n / consumers + (c < n % consumers ? 1 : 0);
+        size_t sum   = 0;
+        int    values[batch];
+        while(share > 0)
+        {
+          if(bulk)
+          {
+            const size_t got = queue.pop_bulk(values, std::min(batch, share));
+            for(size_t j = 0; j < got; j++)
+              sum += static_cast<size_t>(values[j]);
+            share -= got;
+            if(got == 0)
+              std::this_thread::yield();
+          }
+          else
+          {
+            sum += static_cast<size_t>(queue.pop());
+            share--;
+          }
+        }
+        sink += sum;
+      });
+    }
+    for(std::thread& thread : threads)
+      thread.join();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    if(sink.load() != n * (n - 1) / 2)
+      std::cout << "lost elements" << std::endl;
+    return elapsed.count() / n;
+  };
+
+  std::cout << "producers\tconsumers\tpop (ns/item)\tpop_bulk (ns/item)" << std::endl;
+  const size_t counts[][2] = {{1, 1}, {1, 4}, {4, 1}, {2, 2}, {4, 4}, {8, 8}};
+  for(const auto& count : counts)
+  {
+    const double pop_ns  = run(count[0], count[1], false);
+    const double bulk_ns = run(count[0], count[1], true);
+    std::cout << count[0] << "\t\t" << count[1] << "\t\t" << pop_ns << "\t\t" << bulk_ns << std::endl;
+  }
+}
+
+// ns per push/pop pair with every thread hammering one stack: a mutex around Stack, ConcurrentStack,
+// and ConcurrentStack with an elimination array
+void benchmark_concurrent_stack()
+{
+  constexpr size_t n = size_t(1) << 20;
+
+  auto run = [&](size_t threads, auto& stack, auto push, auto pop) {
+    std::vector<std::thread> workers;
+    std::atomic<size_t>      sink{0};
+    auto                     start = std::chrono::steady_clock::now();
+    for(size_t t = 0; t < threads; t++)
+    {
+      workers.emplace_back([&, t] {
+        size_t sum = 0;
+        for(size_t i = t; i < n; i += threads)
+        {
+          push(stack, static_cast<int>(i));
+          sum += static_cast<size_t>(pop(stack));
+        }
+        sink += sum;
+      });
+    }
+    for(std::thread& worker : workers)
+      worker.join();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    if(sink.load() == 0)
+      std::cout << "empty run" << std::endl;
+    return elapsed.count() / n;
+  };
+
+  struct LockedStack
+  {
+    Stack<int> stack;
+    std::mutex mutex;
+  };
+
+  auto locked_push = [](LockedStack& locked, int value) {
+    std::lock_guard<std::mutex> lock(locked.mutex);
+    locked.stack.push(value);
+  };
+  auto locked_pop = [](LockedStack& locked) {
+    std::lock_guard<std::mutex> lock(locked.mutex);
+    int value = locked.stack.top();
+    locked.stack.pop();
+    return value;
+  };
+  auto lock_free_push = [](auto& stack, int value) { stack.push(value); };
+  auto lock_free_pop  = [](auto& stack) {
+    int value;
+    while(!stack.try_pop(value))
+    {
+    }
+    return value;
+  };
+
+  std::cout << "threads\tmutex Stack\tConcurrentStack\twith elimination (ns/pair)" << std::endl;
+  for(size_t threads = 1; threads <= 64; threads *= 2)
+  {
+    LockedStack             locked;
+    ConcurrentStack<int>    plain;
+    ConcurrentStack<int, 8> eliminating;
+    const double locked_ns      = run(threads, locked, locked_push, locked_pop);
+    const double plain_ns       = run(threads, plain, lock_free_push, lock_free_pop);
+    const double eliminating_ns = run(threads, eliminating, lock_free_push, lock_free_pop);
+    std::cout << threads << "\t" << locked_ns << "\t\t" << plain_ns << "\t\t" << eliminating_ns << std::endl;
+  }
+}
+
+// bytes currently held by containers using CountingAllocator
+static size_t counted_bytes = 0;
+
+template <typename T>
+struct CountingAllocator
+{
+  using value_type = T;
+
+  CountingAllocator() = default;
+
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U>&)
+  {
+  }
+
+  T* allocate(size_t n)
+  {
+    counted_bytes += n * sizeof(T);
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* p, size_t n)
+  {
+    counted_bytes -= n * sizeof(T);
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  template <typename U>
+  bool operator==(const CountingAllocator<U>&) const
+  {
+    return true;
+  }
+};
+
+// ns per element through Queue and Stack over Container with a heap-owning payload: push by copy then
+// drain, push by move then drain, a steady 256-deep queue, a stack; and bytes held per element when full
+template <typename Container>
+void benchmark_queue_container(const char* name, const std::vector<typename Container::value_type>& payloads)
+{
+  using T = typename Container::value_type;
+
+  const size_t n    = payloads.size();
+  size_t       sink = 0;
+
+  auto time = [&](auto body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / n;
+  };
+
+  std::vector<T>      pool = payloads;
+  Queue<T, Container> queue;
+  const double        copy_ns = time([&] {
+    for(const T& payload : pool)
+      queue.push(payload);
+    for(; !queue.empty(); queue.pop())
+      sink += queue.front().size();
+  });
+  const double        move_ns = time([&] {
+    for(T& payload : pool)
+      queue.push(std::move(payload));
+    for(; !queue.empty(); queue.pop())
+      sink += queue.front().size();
+  });
+
+  pool = payloads;
+  Queue<T, Container> steady;
+  const double        steady_ns = time([&] {
+    for(T& payload : pool)
+    {
+      steady.push(std::move(payload));
+      if(steady.size() > 256)
+      {
+        sink += steady.front().size();
+        steady.pop();
+      }
+    }
+  });
+
+  pool = payloads;
+  Stack<T, Container> stack;
+  const double        stack_ns = time([&] {
+    for(T& payload : pool)
+      stack.push(std::move(payload));
+    for(; !stack.empty(); stack.pop())
+      sink += stack.top().size();
+  });
+
+  const size_t before = counted_bytes;
+  Container    full;
+  for(const T& payload : payloads)
+    full.push_back(payload);
+  size_t held = counted_bytes - before;
+  if constexpr(requires { full.capacity(); })
+  {
+    held = full.capacity() * sizeof(T);
+  }
+
+  std::cout << name << "\t" << copy_ns << "\t\t" << move_ns << "\t\t" << steady_ns << "\t\t" << stack_ns << "\t\t"
+            << static_cast<double>(held) / n << "\t(" << sink % 10 << ")" << std::endl;
+}
+
+void benchmark_ring_buffer()
+{
+  constexpr size_t n = size_t(1) << 18;
+
+  std::vector<std::string>      strings(n);
+  std::vector<std::vector<int>> buffers(n);
+  for(size_t i = 0; i < n; i++)
+  {
+    strings[i] = std::string(48, static_cast<char>('a' + i % 26));
+    buffers[i] = std::vector<int>(16, static_cast<int>(i));
+  }
+
+  std::cout << "container\t\tcopy push\tmove push\tsteady\t\tstack (ns/elem)\tbytes/elem" << std::endl;
+  benchmark_queue_container<std::deque<std::string, CountingAllocator<std::string>>>("deque<string>\t", strings);
+  benchmark_queue_container<RingBuffer<std::string>>("RingBuffer<string>", strings);
+  benchmark_queue_container<std::deque<std::vector<int>, CountingAllocator<std::vector<int>>>>("deque<vector>\t",
+                                                                                               buffers);
+  benchmark_queue_container<RingBuffer<std::vector<int>>>("RingBuffer<vector>", buffers);
+}
+
+int main(int argc, char** argv)
 {
   // Declare an empty queue of integers
   Queue<int> que;
@@ -156,5 +1654,114 @@ int main()
   {
     std::cout << "Stack is now empty\n";
   }
+
+  // Move and emplace strings instead of copying them
+  Queue<std::string> names;
+  std::string        name(40, 'x');
+  names.push(std::move(name));
+  names.emplace(3, 'y');
+  std::cout << "Queue moved a string (source now " << name.size() << " chars), emplaced \"" << names.back()
+            << "\"\n";
+
+  // Hand elements from one thread to another through a lock-free ring buffer
+  SpscQueue<int, 8> ring;
+  std::thread       producer([&] {
+    for(int i = 1; i <= 20; ++i)
+    {
+      ring.push(i);
+    }
+  });
+  int sum = 0;
+  for(int received = 0; received < 20;)
+  {
+    int value;
+    if(ring.try_pop(value))
+    {
+      sum += value;
+      received++;
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  std::cout << "SpscQueue passed 20 elements, sum " << sum << "\n";
+
+  // Fan in from two producers, drain in batches
+  MpmcQueue<int>           jobs(16);
+  std::vector<std::thread> producers;
+  for(int p = 0; p < 2; ++p)
+  {
+    producers.emplace_back([&jobs, p] {
+      for(int i = 1; i <= 10; ++i)
+      {
+        jobs.push(p * 10 + i);
+      }
+    });
+  }
+  int total = 0;
+  for(int received = 0; received < 20;)
+  {
+    int    batch[4];
+    size_t got = jobs.pop_bulk(batch, 4);
+    for(size_t i = 0; i < got; ++i)
+    {
+      total += batch[i];
+    }
+    received += static_cast<int>(got);
+    if(got == 0)
+    {
+      std::this_thread::yield();
+    }
+  }
+  for(std::thread& thread : producers)
+  {
+    thread.join();
+  }
+  std::cout << "MpmcQueue passed 20 elements, sum " << total << "\n";
+  jobs.push(21);
+  int none[1];
+  std::cout << "MpmcQueue pop_bulk with max 0 takes " << jobs.pop_bulk(none, 0) << ", leaving " << jobs.size()
+            << "\n";
+
+  // Share a free list of slot numbers between threads
+  ConcurrentStack<int> free_slots;
+  for(int slot = 0; slot < 8; ++slot)
+  {
+    free_slots.push(slot);
+  }
+  std::vector<std::thread> users;
+  for(int t = 0; t < 4; ++t)
+  {
+    users.emplace_back([&free_slots] {
+      for(int i = 0; i < 1000; ++i)
+      {
+        int slot;
+        if(free_slots.try_pop(slot))
+        {
+          free_slots.push(slot);
+        }
+      }
+    });
+  }
+  for(std::thread& user : users)
+  {
+    user.join();
+  }
+  int slots = 0;
+  for(int slot; free_slots.try_pop(slot);)
+  {
+    slots++;
+  }
+  std::cout << "ConcurrentStack still holds " << slots << " free slots\n";
+
+  if(argc > 1 && std::string_view(argv[1]) == "--bench")
+  {
+    benchmark_spsc();
+    benchmark_mpmc();
+    benchmark_concurrent_stack();
+    benchmark_ring_buffer();
+  }
   return 0;
 }
@@ -1,4 +1,16 @@
+#include <algorithm>
+#include <bit>
+#include <cstdint>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 /*
 1. A node is either red or black.
 2. The root and leaves (nil, nullptr node) are always black.
@@ -20,6 +32,54 @@ Rotation:
   -- larger subtrees up, smaller subtrees down
 3. left rotation: clockwise rotation
 4. right rotation: counterclockwise rotation
+
+Node allocation:
+RedBlackTree, Set and Map take an allocator (rebound to the node type).
+NodePool is a slab allocator for the nodes:
+  -- nodes are carved out of contiguous chunks of ChunkSize nodes, one malloc per chunk
+  -- erased nodes go to a free list and are handed out again before the chunk grows
+  -- release() frees all chunks at once, so a tree of trivially destructible values
+     is torn down in O(chunks) instead of O(n)
+  -- a pool is owned by one tree: copies of a NodePool start empty and never share nodes
+
+Tree engines:
+Set and Map take the tree as a template template parameter: RedBlackTree (default) or BTree.
+BTree is a B+-tree:
+  -- a node holds up to ~NodeBytes of keys, so one cache miss brings in a whole sorted run of keys
+     instead of one key per level
+  -- values live only in the leaves; inner nodes hold separators (a lower bound of the right subtree,
+     its smallest key until that key is erased)
+  -- every node but the root is at least half full: erase borrows a key from a sibling or merges with it
+  -- leaves are linked in both directions, so a range scan walks leaf after leaf without going up
+  -- the position inside a node is found by counting the keys below the probe,
+     with AVX2/SSE2 compares for arithmetic keys and a binary search otherwise
+  -- the value type must be default constructible and copy assignable (keys are shifted inside nodes)
+
+Bulk construction:
+Set::from_sorted / Map::from_sorted build the tree from a sorted range in O(n), without comparisons
+against the tree or rebalancing (duplicates are skipped, the first one wins).
+  -- RedBlackTree: the middle element becomes the root, recursively; every nil leaf then sits at depth
+     h or h - 1, so coloring the deepest level red and everything else black is a valid red-black tree
+  -- BTree: the leaves are filled left to right, then each inner level is built over the one below
+merge() unions two sorted sequences in one pass and rebuilds the same way, O(n + m).
+
+Order statistics:
+RedBlackTree<T, Allocator, true> (alias OrderStatisticTree) stores the subtree size in every node.
+  -- insert/erase adjust the sizes on the path to the root, a rotation recomputes the two rotated nodes
+  -- nth_element(k), rank(value) and count_in_range(a, b) then walk one root-to-leaf path, O(logN)
+  -- without the flag the size field is an empty member and takes no space
+
+Flat ordered containers:
+FlatSet / FlatMap keep the keys in one contiguous array instead of one heap node per key.
+  -- lookups are a branchless binary search (the loop body is a conditional move),
+     prefetching both candidate midpoints of the next step
+  -- Eytzinger = true stores the keys in BFS order of the implicit search tree (node k has children
+     2k and 2k + 1), so the top levels of every search share a few cache lines, and the cache line
+     holding the descendants four levels down is prefetched while the current level is compared
+  -- iteration stays in key order in both layouts (in-order walk of the implicit tree)
+  -- insert(first, last) appends the batch, sorts only the batch, merges it in and drops duplicates;
+     single inserts and erases are O(n): these containers are for build-once, read-mostly data
+  -- FlatMap keeps the values in a separate array in the same order, so searches only touch keys
 */
 enum Color
 {
@@ -27,7 +87,11 @@ enum Color
   BLACK
 };
 
-template <typename T>
+struct NoSize
+{
+};
+
+template <typename T, bool Ranked = false>
 struct Node
 {
   //K   key; for map
@@ -36,18 +100,173 @@ struct Node
   Node* left;
   Node* right;
   Node* parent;
+  // number of nodes in the subtree rooted here (order-statistic trees only)
+  [[no_unique_address]] std::conditional_t<Ranked, size_t, NoSize> size;
 
-  Node(Color c, Node* p = nullptr, T val)
-      : color(c), left(nullptr), right(nullptr), parent(p), value(val)
+  Node(Color c, Node* p, const T& val)
+      : value(val), color(c), left(nullptr), right(nullptr), parent(p), size()
   {
+    if constexpr(Ranked)
+    {
+      size = 1;
+    }
   }
 };
 
-template <typename T>
+template <typename T, size_t ChunkSize = 4096>
+class NodePool
+{
+  union Slot
+  {
+    Slot* next;    // valid while the slot is on the free list
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  std::vector<Slot*> chunks;
+  Slot*              free_list  = nullptr;
+  size_t             chunk_used = ChunkSize;    // slots handed out from chunks.back()
+
+  public:
+  using value_type = T;
+
+  template <typename U>
+  struct rebind
+  {
+    using other = NodePool<U, ChunkSize>;
+  };
+
+  NodePool() = default;
+
+  NodePool(const NodePool&) : NodePool() {}
+
+  template <typename U>
+  NodePool(const NodePool<U, ChunkSize>&) : NodePool()
+  {
+  }
+
+  NodePool(NodePool&& other) noexcept
+      : chunks(std::move(other.chunks)),
+        free_list(std::exchange(other.free_list, nullptr)),
+        chunk_used(std::exchange(other.chunk_used, ChunkSize))
+  {
+  }
+
+  NodePool& operator=(NodePool other) noexcept
+  {
+    std::swap(chunks, other.chunks);
+    std::swap(free_list, other.free_list);
+    std::swap(chunk_used, other.chunk_used);
+    return *this;
+  }
+
+  ~NodePool()
+  {
+    release();
+  }
+
+  T* allocate(size_t n)
+  {
+    if(n != 1)
+    {
+      return std::allocator<T>{}.allocate(n);    // only single nodes are pooled
+    }
+    if(free_list != nullptr)
+    {
+      Slot* slot = free_list;
+      free_list  = slot->next;
+      return reinterpret_cast<T*>(slot);
+    }
+    if(chunk_used == ChunkSize)
+    {
+      chunks.push_back(std::allocator<Slot>{}.allocate(ChunkSize));
+      chunk_used = 0;
+    }
+    return reinterpret_cast<T*>(&chunks.back()[chunk_used++]);
+  }
+
+  void deallocate(T* p, size_t n)
+  {
+    if(n != 1)
+    {
+      std::allocator<T>{}.deallocate(p, n);
+      return;
+    }
+    Slot* slot = reinterpret_cast<Slot*>(p);
+    slot->next = free_list;
+    free_list  = slot;
+  }
+
+  // frees every chunk; objects still living in them are not destroyed
+  void release()
+  {
+    for(Slot* chunk : chunks)
+    {
+      std::allocator<Slot>{}.deallocate(chunk, ChunkSize);
+    }
+    chunks.clear();
+    free_list  = nullptr;
+    chunk_used = ChunkSize;
+  }
+
+  bool operator==(const NodePool& other) const
+  {
+    return this == &other;
+  }
+};
+
+// number of distinct elements in the sorted range [first, last)
+template <typename It>
+size_t count_distinct(It first, It last)
+{
+  size_t count = 0;
+  while(first != last)
+  {
+    It prev = first++;
+    while(first != last && !(*prev < *first))
+    {
+      ++first;
+    }
+    count++;
+  }
+  return count;
+}
+
+// returns *first and moves first past every element equal to it
+template <typename It>
+auto take_distinct(It& first, It last)
+{
+  It prev = first++;
+  while(first != last && !(*prev < *first))
+  {
+    ++first;
+  }
+  return *prev;
+}
+
+template <typename T, typename Allocator = std::allocator<T>, bool Ranked = false>
 class RedBlackTree
 {
   private:
-  Node* root;
+  using Node          = ::Node<T, Ranked>;
+  using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+  using NodeTraits    = std::allocator_traits<NodeAllocator>;
+
+  Node*         root;
+  size_t        size_;
+  NodeAllocator allocator;
+
+  Node* createNode(Color color, Node* parent, const T& value)
+  {
+    Node* node = NodeTraits::allocate(allocator, 1);
+    NodeTraits::construct(allocator, node, color, parent, value);
+    return node;
+  }
+
+  void destroyNode(Node* node)
+  {
+    NodeTraits::destroy(allocator, node);
+    NodeTraits::deallocate(allocator, node, 1);
+  }
 
   void deleteTree(Node* node)
   {
@@ -55,9 +274,26 @@ class RedBlackTree
     {
       deleteTree(node->left);
       deleteTree(node->right);
-      delete node;
+      destroyNode(node);
+    }
+  }
+  static size_t subtreeSize(const Node* node)
+  {
+    if constexpr(Ranked)
+    {
+      return node == nullptr ? 0 : node->size;
+    }
+    return 0;
+  }
+
+  static void updateSize(Node* node)
+  {
+    if constexpr(Ranked)
+    {
+      node->size = subtreeSize(node->left) + subtreeSize(node->right) + 1;
     }
   }
+
   //! very annoying to write
   // GOAL: node x become the [left child] of its [right child] y
   // totally six pointers need to be updated
@@ -84,6 +320,11 @@ class RedBlackTree
     }
     y->left   = x;    // make x the left child of y
     x->parent = y;    // update the parent of x to y.
+    if constexpr(Ranked)
+    {
+      y->size = x->size;    // y now roots the subtree x used to root
+      updateSize(x);
+    }
   }
   // symmetric operations of rotateLeft
   // GOAL: node y become the [right child] of its [left child] x
@@ -112,6 +353,11 @@ class RedBlackTree
 
     x->right  = y;
     y->parent = x;
+    if constexpr(Ranked)
+    {
+      x->size = y->size;
+      updateSize(y);
+    }
   }
 
   void fixViolations(Node* x)
@@ -175,95 +421,2003 @@ class RedBlackTree
     root->color = BLACK;
   }
 
-  void insert(Node*& node, Node* parent, const T& value)
+  // replaces the subtree rooted at u with the subtree rooted at v (v may be nullptr)
+  void transplant(Node* u, Node* v)
   {
-    if(node == nullptr)
+    if(u->parent == nullptr)
     {
-      node = new Node(RED, parent, value);    // insert the node and color it RED
-      fixViolations(node);
-      return;
+      root = v;
     }
-
-    if(value == node->value)
+    else if(u == u->parent->left)
     {
-      return;    // no need to insert
+      u->parent->left = v;
     }
-
-    if(value < node->value)
+    else
     {
-      insert(node->left, node, value);
+      u->parent->right = v;
     }
-    else
+    if(v != nullptr)
     {
-      insert(node->right, node, value);
+      v->parent = u->parent;
     }
   }
 
-  public:
-  RedBlackTree() : root(nullptr) {}
+  static bool isBlack(const Node* node)
+  {
+    return node == nullptr || node->color == BLACK;    // nil leaves are black
+  }
 
-  ~RedBlackTree()
+  static Node* minimum(Node* node)
   {
-    deleteTree(root);
+    while(node->left != nullptr)
+    {
+      node = node->left;
+    }
+    return node;
   }
-};
 
-template <typename T>
-class Set
-{
-  private:
-  RedBlackTree<T> tree;
+  static Node* maximum(Node* node)
+  {
+    while(node->right != nullptr)
+    {
+      node = node->right;
+    }
+    return node;
+  }
 
-  public:
-  void insert(const T& value)
+  // builds a balanced subtree from the next n distinct elements, in order; nodes at red_depth are red
+  template <typename It>
+  Node* build(It& first, It last, size_t n, size_t depth, size_t red_depth, Node* parent)
   {
-    tree.insert(value);
+    if(n == 0)
+    {
+      return nullptr;
+    }
+    const size_t left_count = (n - 1) / 2;
+    Node*        left       = build(first, last, left_count, depth + 1, red_depth, nullptr);
+    Node*        node       = createNode(depth == red_depth ? RED : BLACK, parent, take_distinct(first, last));
+    node->left              = left;
+    if(left != nullptr)
+    {
+      left->parent = node;
+    }
+    node->right = build(first, last, n - 1 - left_count, depth + 1, red_depth, node);
+    if constexpr(Ranked)
+    {
+      node->size = n;
+    }
+    return node;
   }
 
-  bool find(const T& value)
+  // unlinks z; a node with two children is replaced by its successor node (not by a copy of its value),
+  // so iterators to every other element stay valid
+  void eraseNode(Node* z)
+  {
+    Node* y              = z;
+    Color original_color = y->color;
+    Node* x;           // the node that moves into y's old position, may be nullptr
+    Node* x_parent;    // x's parent, tracked separately because x may be nullptr
+
+    if(z->left == nullptr)
+    {
+      x        = z->right;
+      x_parent = z->parent;
+      transplant(z, z->right);
+    }
+    else if(z->right == nullptr)
+    {
+      x        = z->left;
+      x_parent = z->parent;
+      transplant(z, z->left);
+    }
+    else
+    {
+      y              = minimum(z->right);
+      original_color = y->color;
+      x              = y->right;
+      if(y->parent == z)
+      {
+        x_parent = y;
+      }
+      else
+      {
+        x_parent = y->parent;
+        transplant(y, y->right);
+        y->right         = z->right;
+        y->right->parent = y;
+      }
+      transplant(z, y);
+      y->left         = z->left;
+      y->left->parent = y;
+      y->color        = z->color;
+    }
+    destroyNode(z);
+    size_--;
+
+    if constexpr(Ranked)
+    {
+      // every node that lost a descendant is on the path from x_parent up (y, if moved, is on it too)
+      for(Node* node = x_parent; node != nullptr; node = node->parent)
+      {
+        updateSize(node);
+      }
+    }
+
+    if(original_color == BLACK)
+    {
+      fixDelete(x, x_parent);    // a black node left its path: x carries an extra black
+    }
+  }
+
+  void fixDelete(Node* x, Node* parent)
   {
-    return tree.find(value);
+    while(x != root && isBlack(x))
+    {
+      // Case A: x is left child; its sibling exists because x's side is a black short
+      if(x == parent->left)
+      {
+        Node* sibling = parent->right;
+        if(sibling->color == RED)    // red sibling: rotate to get a black sibling
+        {
+          sibling->color = BLACK;
+          parent->color  = RED;
+          rotateLeft(parent);
+          sibling = parent->right;
+        }
+        if(isBlack(sibling->left) && isBlack(sibling->right))    // push the extra black up
+        {
+          sibling->color = RED;
+          x              = parent;
+          parent         = x->parent;
+        }
+        else
+        {
+          if(isBlack(sibling->right))    // near nephew red: rotate it into the far position
+          {
+            sibling->left->color = BLACK;
+            sibling->color       = RED;
+            rotateRight(sibling);
+            sibling = parent->right;
+          }
+          // far nephew red: one rotation absorbs the extra black
+          sibling->color        = parent->color;
+          parent->color         = BLACK;
+          sibling->right->color = BLACK;
+          rotateLeft(parent);
+          x = root;
+        }
+      }
+      else
+      {    // Case B: x is right child, symmetric
+        Node* sibling = parent->left;
+        if(sibling->color == RED)
+        {
+          sibling->color = BLACK;
+          parent->color  = RED;
+          rotateRight(parent);
+          sibling = parent->left;
+        }
+        if(isBlack(sibling->left) && isBlack(sibling->right))
+        {
+          sibling->color = RED;
+          x              = parent;
+          parent         = x->parent;
+        }
+        else
+        {
+          if(isBlack(sibling->left))
+          {
+            sibling->right->color = BLACK;
+            sibling->color        = RED;
+            rotateLeft(sibling);
+            sibling = parent->left;
+          }
+          sibling->color       = parent->color;
+          parent->color        = BLACK;
+          sibling->left->color = BLACK;
+          rotateRight(parent);
+          x = root;
+        }
+      }
+    }
+    if(x != nullptr)
+    {
+      x->color = BLACK;
+    }
   }
-};
 
-template <typename K, typename V>
-struct Pair
-{
-  K key;
-  V value;
+  public:
+  // in-order traversal: successor is the leftmost node of the right subtree,
+  // or the first ancestor reached from a left child
+  class iterator
+  {
+    public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type        = T;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const T*;
+    using reference         = const T&;
 
-  Pair(const K& k, const V& v) : key(k), value(v) {}
+    iterator() = default;
 
-  bool operator<(const Pair& rhs) const
+    iterator(const RedBlackTree* tree, Node* node) : tree(tree), node(node) {}
+
+    reference operator*() const
+    {
+      return node->value;
+    }
+
+    pointer operator->() const
+    {
+      return &node->value;
+    }
+
+    iterator& operator++()
+    {
+      if(node->right != nullptr)
+      {
+        node = minimum(node->right);
+        return *this;
+      }
+      Node* parent = node->parent;
+      while(parent != nullptr && node == parent->right)
+      {
+        node   = parent;
+        parent = parent->parent;
+      }
+      node = parent;
+      return *this;
+    }
+
+    iterator operator++(int)
+    {
+      iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    iterator& operator--()
+    {
+      if(node == nullptr)    // end() steps back to the largest element
+      {
+        node = maximum(tree->root);
+        return *this;
+      }
+      if(node->left != nullptr)
+      {
+        node = maximum(node->left);
+        return *this;
+      }
+      Node* parent = node->parent;
+      while(parent != nullptr && node == parent->left)
+      {
+        node   = parent;
+        parent = parent->parent;
+      }
+      node = parent;
+      return *this;
+    }
+
+    iterator operator--(int)
+    {
+      iterator old = *this;
+      --*this;
+      return old;
+    }
+
+    bool operator==(const iterator& other) const
+    {
+      return node == other.node;
+    }
+
+    private:
+    friend class RedBlackTree;
+
+    const RedBlackTree* tree = nullptr;
+    Node*               node = nullptr;
+  };
+
+  RedBlackTree(const Allocator& alloc = Allocator()) : root(nullptr), size_(0), allocator(alloc) {}
+
+  RedBlackTree(const RedBlackTree&)            = delete;
+  RedBlackTree& operator=(const RedBlackTree&) = delete;
+
+  RedBlackTree(RedBlackTree&& other) noexcept
+      : root(std::exchange(other.root, nullptr)),
+        size_(std::exchange(other.size_, 0)),
+        allocator(std::move(other.allocator))
   {
-    return key < rhs.key;
   }
-};
 
-template <typename K, typename V>
-class Map
-{
-  private:
-  RedBlackTree<Pair<K, V>> tree;
+  ~RedBlackTree()
+  {
+    clear();
+  }
 
-  public:
-  void insert(const K& key, const V& value)
+  void clear()
   {
-    tree.insert(Pair<K, V>(key, value));
+    if constexpr(requires { allocator.release(); } && std::is_trivially_destructible_v<T>)
+    {
+      allocator.release();    // nothing to destroy, hand back whole chunks
+    }
+    else
+    {
+      deleteTree(root);
+    }
+    root  = nullptr;
+    size_ = 0;
   }
 
-  void find(const K& key)
+  // replaces the contents with the sorted range [first, last) in O(n)
+  template <typename It>
+  void assign_sorted(It first, It last)
   {
-    return tree.find(Pair<K, V>(key, V()));
+    clear();
+    const size_t n = count_distinct(first, last);
+    // the deepest level is red, unless it is the root (n == 1)
+    const size_t red_depth = n > 1 ? std::bit_width(n) - 1 : SIZE_MAX;
+    root                   = build(first, last, n, 0, red_depth, nullptr);
+    size_                  = n;
   }
-};
 
-int main()
-{
-  Set<int> my_set;
-  my_set.insert(5);
-  my_set.insert(3);
-  my_set.insert(7);
+  std::pair<iterator, bool> insert(const T& value)
+  {
+    Node* parent = nullptr;
+    Node* node   = root;
+    while(node != nullptr)
+    {
+      parent = node;
+      if(value < node->value)
+      {
+        node = node->left;
+      }
+      else if(node->value < value)
+      {
+        node = node->right;
+      }
+      else
+      {
+        return {iterator(this, node), false};    // already present, no need to insert
+      }
+    }
+
+    node = createNode(RED, parent, value);    // insert the node and color it RED
+    if(parent == nullptr)
+    {
+      root = node;
+    }
+    else if(value < parent->value)
+    {
+      parent->left = node;
+    }
+    else
+    {
+      parent->right = node;
+    }
+    if constexpr(Ranked)
+    {
+      for(Node* ancestor = parent; ancestor != nullptr; ancestor = ancestor->parent)
+      {
+        ancestor->size++;
+      }
+    }
+    fixViolations(node);    // rotations move nodes around, but node itself stays valid
+    size_++;
+    return {iterator(this, node), true};
+  }
+
+  iterator find(const T& value) const
+  {
+    Node* node = root;
+    while(node != nullptr)
+    {
+      if(value < node->value)
+      {
+        node = node->left;
+      }
+      else if(node->value < value)
+      {
+        node = node->right;
+      }
+      else
+      {
+        return iterator(this, node);
+      }
+    }
+    return end();
+  }
+
+  // returns the number of erased elements (0 or 1)
+  size_t erase(const T& value)
+  {
+    iterator it = find(value);
+    if(it == end())
+    {
+      return 0;
+    }
+    eraseNode(it.node);
+    return 1;
+  }
+
+  // returns the iterator following the erased element
+  iterator erase(iterator pos)
+  {
+    iterator next = std::next(pos);
+    eraseNode(pos.node);
+    return next;
+  }
+
+  // first element not less than value
+  iterator lower_bound(const T& value) const
+  {
+    Node* result = nullptr;
+    Node* node   = root;
+    while(node != nullptr)
+    {
+      if(node->value < value)
+      {
+        node = node->right;
+      }
+      else
+      {
+        result = node;
+        node   = node->left;
+      }
+    }
+    return iterator(this, result);
+  }
+
+  // first element greater than value
+  iterator upper_bound(const T& value) const
+  {
+    Node* result = nullptr;
+    Node* node   = root;
+    while(node != nullptr)
+    {
+      if(value < node->value)
+      {
+        result = node;
+        node   = node->left;
+      }
+      else
+      {
+        node = node->right;
+      }
+    }
+    return iterator(this, result);
+  }
+
+  // [lower_bound, upper_bound): the element equal to value, if any
+  std::pair<iterator, iterator> equal_range(const T& value) const
+  {
+    return {lower_bound(value), upper_bound(value)};
+  }
+
+  // the k-th smallest element (0-based), end() if k >= size()
+  iterator nth_element(size_t k) const
+    requires Ranked
+  {
+    Node* node = root;
+    while(node != nullptr)
+    {
+      const size_t left_size = subtreeSize(node->left);
+      if(k < left_size)
+      {
+        node = node->left;
+      }
+      else if(k == left_size)
+      {
+        break;
+      }
+      else
+      {
+        k -= left_size + 1;
+        node = node->right;
+      }
+    }
+    return iterator(this, node);
+  }
+
+  // number of elements less than value
+  size_t rank(const T& value) const
+    requires Ranked
+  {
+    size_t rank = 0;
+    Node*  node = root;
+    while(node != nullptr)
+    {
+      if(node->value < value)
+      {
+        rank += subtreeSize(node->left) + 1;
+        node = node->right;
+      }
+      else
+      {
+        node = node->left;
+      }
+    }
+    return rank;
+  }
+
+  // number of elements in [first, last)
+  size_t count_in_range(const T& first, const T& last) const
+    requires Ranked
+  {
+    return first < last ? rank(last) - rank(first) : 0;
+  }
+
+  iterator begin() const
+  {
+    return iterator(this, root == nullptr ? nullptr : minimum(root));
+  }
+
+  iterator end() const
+  {
+    return iterator(this, nullptr);
+  }
+
+  size_t size() const
+  {
+    return size_;
+  }
+};
+
+template <typename T, typename Allocator = std::allocator<T>>
+using OrderStatisticTree = RedBlackTree<T, Allocator, true>;
+
+// number of keys in the sorted array keys[0, n) that are less than value, i.e. the lower bound
+template <typename T>
+size_t count_less(const T* keys, size_t n, const T& value)
+{
+  if constexpr(std::is_arithmetic_v<T>)
+  {
+    size_t i     = 0;
+    size_t count = 0;
+#if defined(__AVX2__)
+    if constexpr(std::is_integral_v<T> && std::is_signed_v<T> && sizeof(T) == 4)
+    {
+      const __m256i probe = _mm256_set1_epi32(value);
+      for(; i + 8 <= n; i += 8)
+      {
+        __m256i less = _mm256_cmpgt_epi32(probe, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)));
+        count += std::popcount(static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(less))));
+      }
+    }
+    else if constexpr(std::is_integral_v<T> && std::is_signed_v<T> && sizeof(T) == 8)
+    {
+      const __m256i probe = _mm256_set1_epi64x(value);
+      for(; i + 4 <= n; i += 4)
+      {
+        __m256i less = _mm256_cmpgt_epi64(probe, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)));
+        count += std::popcount(static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(less))));
+      }
+    }
+    else if constexpr(std::is_same_v<T, float>)
+    {
+      const __m256 probe = _mm256_set1_ps(value);
+      for(; i + 8 <= n; i += 8)
+      {
+        __m256 less = _mm256_cmp_ps(_mm256_loadu_ps(keys + i), probe, _CMP_LT_OQ);
+        count += std::popcount(static_cast<uint32_t>(_mm256_movemask_ps(less)));
+      }
+    }
+    else if constexpr(std::is_same_v<T, double>)
+    {
+      const __m256d probe = _mm256_set1_pd(value);
+      for(; i + 4 <= n; i += 4)
+      {
+        __m256d less = _mm256_cmp_pd(_mm256_loadu_pd(keys + i), probe, _CMP_LT_OQ);
+        count += std::popcount(static_cast<uint32_t>(_mm256_movemask_pd(less)));
+      }
+    }
+#elif defined(__SSE2__)
+    if constexpr(std::is_integral_v<T> && std::is_signed_v<T> && sizeof(T) == 4)
+    {
+      const __m128i probe = _mm_set1_epi32(value);
+      for(; i + 4 <= n; i += 4)
+      {
+        __m128i less = _mm_cmpgt_epi32(probe, _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)));
+        count += std::popcount(static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(less))));
+      }
+    }
+    else if constexpr(std::is_same_v<T, float>)
+    {
+      const __m128 probe = _mm_set1_ps(value);
+      for(; i + 4 <= n; i += 4)
+      {
+        count += std::popcount(static_cast<uint32_t>(_mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(keys + i), probe))));
+      }
+    }
+    else if constexpr(std::is_same_v<T, double>)
+    {
+      const __m128d probe = _mm_set1_pd(value);
+      for(; i + 2 <= n; i += 2)
+      {
+        count += std::popcount(static_cast<uint32_t>(_mm_movemask_pd(_mm_cmplt_pd(_mm_loadu_pd(keys + i), probe))));
+      }
+    }
+#endif
+    for(; i < n; i++)
+    {
+      count += keys[i] < value;    // branchless tail (and the whole node for other arithmetic types)
+    }
+    return count;
+  }
+  else
+  {
+    return static_cast<size_t>(std::lower_bound(keys, keys + n, value) - keys);
+  }
+}
+
+template <typename T, typename Allocator = std::allocator<T>, size_t NodeBytes = 512>
+class BTree
+{
+  private:
+  static constexpr size_t capacity = std::max<size_t>(NodeBytes / sizeof(T), 4);    // keys per node
+
+  struct Node
+  {
+    bool   leaf;
+    size_t count;
+    T      keys[capacity];
+  };
+
+  struct Leaf : Node
+  {
+    Leaf* prev;
+    Leaf* next;
+  };
+
+  struct Inner : Node
+  {
+    Node* children[capacity + 1];
+  };
+
+  using LeafAllocator  = typename std::allocator_traits<Allocator>::template rebind_alloc<Leaf>;
+  using InnerAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Inner>;
+  using LeafTraits     = std::allocator_traits<LeafAllocator>;
+  using InnerTraits    = std::allocator_traits<InnerAllocator>;
+
+  static constexpr size_t min_count = capacity / 2;    // fill kept by every node but the root
+  static constexpr size_t max_depth = 64;
+
+  Node*          root;
+  Leaf*          head;    // leftmost leaf
+  Leaf*          tail;    // rightmost leaf
+  size_t         size_;
+  LeafAllocator  leaf_allocator;
+  InnerAllocator inner_allocator;
+
+  public:
+  class iterator
+  {
+    public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type        = T;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const T*;
+    using reference         = const T&;
+
+    iterator() = default;
+
+    iterator(const BTree* tree, Leaf* leaf, size_t index) : tree(tree), leaf(leaf), index(index) {}
+
+    reference operator*() const
+    {
+      return leaf->keys[index];
+    }
+
+    pointer operator->() const
+    {
+      return &leaf->keys[index];
+    }
+
+    iterator& operator++()
+    {
+      if(++index == leaf->count)
+      {
+        leaf  = leaf->next;
+        index = 0;
+      }
+      return *this;
+    }
+
+    iterator operator++(int)
+    {
+      iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    iterator& operator--()
+    {
+      if(leaf == nullptr)
+      {
+        leaf  = tree->tail;
+        index = leaf->count;
+      }
+      if(index == 0)
+      {
+        leaf  = leaf->prev;
+        index = leaf->count;
+      }
+      --index;
+      return *this;
+    }
+
+    iterator operator--(int)
+    {
+      iterator old = *this;
+      --*this;
+      return old;
+    }
+
+    bool operator==(const iterator& other) const
+    {
+      return leaf == other.leaf && index == other.index;
+    }
+
+    private:
+    const BTree* tree  = nullptr;
+    Leaf*        leaf  = nullptr;
+    size_t       index = 0;
+  };
+
+  BTree(const Allocator& alloc = Allocator())
+      : root(nullptr), head(nullptr), tail(nullptr), size_(0), leaf_allocator(alloc), inner_allocator(alloc)
+  {
+  }
+
+  BTree(const BTree&)            = delete;
+  BTree& operator=(const BTree&) = delete;
+
+  BTree(BTree&& other) noexcept
+      : root(std::exchange(other.root, nullptr)),
+        head(std::exchange(other.head, nullptr)),
+        tail(std::exchange(other.tail, nullptr)),
+        size_(std::exchange(other.size_, 0)),
+        leaf_allocator(std::move(other.leaf_allocator)),
+        inner_allocator(std::move(other.inner_allocator))
+  {
+  }
+
+  ~BTree()
+  {
+    deleteTree(root);
+  }
+
+  void clear()
+  {
+    deleteTree(root);
+    root = head = tail = nullptr;
+    size_              = 0;
+  }
+
+  // replaces the contents with the sorted range [first, last) in O(n): full leaves, then inner levels
+  template <typename It>
+  void assign_sorted(It first, It last)
+  {
+    clear();
+    const size_t n = count_distinct(first, last);
+    if(n == 0)
+    {
+      return;
+    }
+
+    // spread the elements evenly over the fewest leaves that hold them
+    std::vector<Node*> level;
+    std::vector<T>     smallest;    // smallest key under each node of the level, i.e. its separator
+    const size_t       leaves = (n + capacity - 1) / capacity;
+    for(size_t i = 0; i < leaves; i++)
+    {
+      Leaf* leaf  = createLeaf();
+      leaf->count = n * (i + 1) / leaves - n * i / leaves;
+      for(size_t j = 0; j < leaf->count; j++)
+      {
+        leaf->keys[j] = take_distinct(first, last);
+      }
+      leaf->prev = tail;
+      (tail != nullptr ? tail->next : head) = leaf;
+      tail                                  = leaf;
+      level.push_back(leaf);
+      smallest.push_back(leaf->keys[0]);
+    }
+
+    // each inner node takes up to capacity + 1 children of the level below
+    while(level.size() > 1)
+    {
+      std::vector<Node*> parents;
+      std::vector<T>     parent_smallest;
+      const size_t       count = (level.size() + capacity) / (capacity + 1);
+      for(size_t i = 0; i < count; i++)
+      {
+        const size_t begin = level.size() * i / count;
+        const size_t end   = level.size() * (i + 1) / count;
+        Inner*       inner = createInner();
+        std::copy(level.begin() + begin, level.begin() + end, inner->children);
+        std::copy(smallest.begin() + begin + 1, smallest.begin() + end, inner->keys);
+        inner->count = end - begin - 1;
+        parents.push_back(inner);
+        parent_smallest.push_back(smallest[begin]);
+      }
+      level    = std::move(parents);
+      smallest = std::move(parent_smallest);
+    }
+    root  = level.front();
+    size_ = n;
+  }
+
+  std::pair<iterator, bool> insert(const T& value)
+  {
+    if(root == nullptr)
+    {
+      head = tail = createLeaf();
+      root        = head;
+    }
+
+    // descend to the leaf, remembering the path for the splits
+    Inner* path[max_depth];
+    size_t slots[max_depth];
+    size_t depth = 0;
+    Node*  node  = root;
+    while(!node->leaf)
+    {
+      Inner* inner = static_cast<Inner*>(node);
+      size_t slot  = childIndex(inner, value);
+      path[depth]  = inner;
+      slots[depth] = slot;
+      node         = inner->children[slot];
+      depth++;
+    }
+
+    Leaf*  leaf  = static_cast<Leaf*>(node);
+    size_t index = count_less(leaf->keys, leaf->count, value);
+    if(index < leaf->count && !(value < leaf->keys[index]))
+    {
+      return {iterator(this, leaf, index), false};    // already present
+    }
+
+    if(leaf->count < capacity)
+    {
+      insertAt(leaf, index, value);
+    }
+    else
+    {
+      Leaf* right = splitLeaf(leaf);
+      if(index > leaf->count)
+      {
+        index -= leaf->count;
+        leaf = right;
+      }
+      insertAt(leaf, index, value);
+      insertIntoParent(path, slots, depth, right->keys[0], right);
+    }
+    size_++;
+    return {iterator(this, leaf, index), true};
+  }
+
+  iterator find(const T& value) const
+  {
+    iterator it = lower_bound(value);
+    return it != end() && !(value < *it) ? it : end();
+  }
+
+  // first element not less than value
+  iterator lower_bound(const T& value) const
+  {
+    if(root == nullptr)
+    {
+      return end();
+    }
+    Leaf*  leaf  = findLeaf(value);
+    size_t index = count_less(leaf->keys, leaf->count, value);
+    return index < leaf->count ? iterator(this, leaf, index) : iterator(this, leaf->next, 0);
+  }
+
+  // first element greater than value
+  iterator upper_bound(const T& value) const
+  {
+    iterator it = lower_bound(value);
+    return it != end() && !(value < *it) ? ++it : it;
+  }
+
+  std::pair<iterator, iterator> equal_range(const T& value) const
+  {
+    return {lower_bound(value), upper_bound(value)};
+  }
+
+  // returns the number of erased elements (0 or 1); a node left below half full borrows a key
+  // from a sibling or is merged with it, so every node but the root stays at least half full
+  size_t erase(const T& value)
+  {
+    if(root == nullptr)
+    {
+      return 0;
+    }
+    Inner* path[max_depth];
+    size_t slots[max_depth];
+    size_t depth = 0;
+    Node*  node  = root;
+    while(!node->leaf)
+    {
+      Inner* inner = static_cast<Inner*>(node);
+      size_t slot  = childIndex(inner, value);
+      path[depth]  = inner;
+      slots[depth] = slot;
+      node         = inner->children[slot];
+      depth++;
+    }
+
+    Leaf*  leaf  = static_cast<Leaf*>(node);
+    size_t index = count_less(leaf->keys, leaf->count, value);
+    if(index == leaf->count || value < leaf->keys[index])
+    {
+      return 0;
+    }
+    std::move(leaf->keys + index + 1, leaf->keys + leaf->count, leaf->keys + index);
+    leaf->count--;
+    size_--;
+    if(leaf->count < min_count && leaf != root)
+    {
+      rebalance(path, slots, depth);
+    }
+    return 1;
+  }
+
+  iterator begin() const
+  {
+    return iterator(this, size_ == 0 ? nullptr : head, 0);
+  }
+
+  iterator end() const
+  {
+    return iterator(this, nullptr, 0);
+  }
+
+  size_t size() const
+  {
+    return size_;
+  }
+
+  private:
+  Leaf* createLeaf()
+  {
+    Leaf* leaf = LeafTraits::allocate(leaf_allocator, 1);
+    LeafTraits::construct(leaf_allocator, leaf);
+    leaf->leaf  = true;
+    leaf->count = 0;
+    leaf->prev  = nullptr;
+    leaf->next  = nullptr;
+    return leaf;
+  }
+
+  Inner* createInner()
+  {
+    Inner* inner = InnerTraits::allocate(inner_allocator, 1);
+    InnerTraits::construct(inner_allocator, inner);
+    inner->leaf  = false;
+    inner->count = 0;
+    return inner;
+  }
+
+  void deleteTree(Node* node)
+  {
+    if(node == nullptr)
+    {
+      return;
+    }
+    if(node->leaf)
+    {
+      LeafTraits::destroy(leaf_allocator, static_cast<Leaf*>(node));
+      LeafTraits::deallocate(leaf_allocator, static_cast<Leaf*>(node), 1);
+      return;
+    }
+    Inner* inner = static_cast<Inner*>(node);
+    for(size_t i = 0; i <= inner->count; i++)
+    {
+      deleteTree(inner->children[i]);
+    }
+    InnerTraits::destroy(inner_allocator, inner);
+    InnerTraits::deallocate(inner_allocator, inner, 1);
+  }
+
+  // child i holds the keys in [keys[i - 1], keys[i])
+  static size_t childIndex(const Inner* inner, const T& value)
+  {
+    size_t index = count_less(inner->keys, inner->count, value);
+    if(index < inner->count && !(value < inner->keys[index]))
+    {
+      index++;    // equal to the separator: it is the smallest key of the right subtree
+    }
+    return index;
+  }
+
+  Leaf* findLeaf(const T& value) const
+  {
+    Node* node = root;
+    while(!node->leaf)
+    {
+      const Inner* inner = static_cast<const Inner*>(node);
+      node               = inner->children[childIndex(inner, value)];
+    }
+    return static_cast<Leaf*>(node);
+  }
+
+  static void insertAt(Leaf* leaf, size_t index, const T& value)
+  {
+    std::move_backward(leaf->keys + index, leaf->keys + leaf->count, leaf->keys + leaf->count + 1);
+    leaf->keys[index] = value;
+    leaf->count++;
+  }
+
+  // restores the fill of the underfull child path[depth - 1]->children[slots[depth - 1]]: borrow one key
+  // from a sibling that can spare it, otherwise merge with a sibling and repeat one level up
+  void rebalance(Inner** path, size_t* slots, size_t depth)
+  {
+    while(depth > 0)
+    {
+      Inner* parent = path[--depth];
+      size_t slot   = slots[depth];
+      Node*  left   = slot > 0 ? parent->children[slot - 1] : nullptr;
+      Node*  right  = slot < parent->count ? parent->children[slot + 1] : nullptr;
+      if(left != nullptr && left->count > min_count)
+      {
+        borrowFromLeft(parent, slot);
+        return;
+      }
+      if(right != nullptr && right->count > min_count)
+      {
+        borrowFromRight(parent, slot);
+        return;
+      }
+      mergeChildren(parent, left != nullptr ? slot - 1 : slot);
+
+      if(parent == root)
+      {
+        if(parent->count == 0)
+        {
+          // the root lost its last separator: its only child becomes the root
+          root                = parent->children[0];
+          parent->children[0] = nullptr;
+          deleteTree(parent);
+        }
+        return;
+      }
+      if(parent->count >= min_count)
+      {
+        return;
+      }
+    }
+  }
+
+  // moves the last key of children[slot - 1] to the front of children[slot]
+  void borrowFromLeft(Inner* parent, size_t slot)
+  {
+    Node* node = parent->children[slot];
+    Node* left = parent->children[slot - 1];
+    std::move_backward(node->keys, node->keys + node->count, node->keys + node->count + 1);
+    if(node->leaf)
+    {
+      node->keys[0]          = std::move(left->keys[left->count - 1]);
+      parent->keys[slot - 1] = node->keys[0];
+    }
+    else
+    {
+      // rotate through the parent: the separator comes down, the left sibling's last key goes up
+      Inner* inner = static_cast<Inner*>(node);
+      Inner* from  = static_cast<Inner*>(left);
+      std::copy_backward(inner->children, inner->children + inner->count + 1, inner->children + inner->count + 2);
+      inner->keys[0]         = std::move(parent->keys[slot - 1]);
+      inner->children[0]     = from->children[from->count];
+      parent->keys[slot - 1] = std::move(from->keys[from->count - 1]);
+    }
+    left->count--;
+    node->count++;
+  }
+
+  // moves the first key of children[slot + 1] to the back of children[slot]
+  void borrowFromRight(Inner* parent, size_t slot)
+  {
+    Node* node  = parent->children[slot];
+    Node* right = parent->children[slot + 1];
+    if(node->leaf)
+    {
+      node->keys[node->count] = std::move(right->keys[0]);
+      std::move(right->keys + 1, right->keys + right->count, right->keys);
+      parent->keys[slot] = right->keys[0];
+    }
+    else
+    {
+      Inner* inner                      = static_cast<Inner*>(node);
+      Inner* from                       = static_cast<Inner*>(right);
+      inner->keys[inner->count]         = std::move(parent->keys[slot]);
+      inner->children[inner->count + 1] = from->children[0];
+      parent->keys[slot]                = std::move(from->keys[0]);
+      std::move(from->keys + 1, from->keys + from->count, from->keys);
+      std::copy(from->children + 1, from->children + from->count + 1, from->children);
+    }
+    right->count--;
+    node->count++;
+  }
+
+  // appends children[slot + 1] to children[slot], frees it and drops the separator between them
+  void mergeChildren(Inner* parent, size_t slot)
+  {
+    Node* left  = parent->children[slot];
+    Node* right = parent->children[slot + 1];
+    if(left->leaf)
+    {
+      Leaf* to   = static_cast<Leaf*>(left);
+      Leaf* from = static_cast<Leaf*>(right);
+      std::move(from->keys, from->keys + from->count, to->keys + to->count);
+      to->count += from->count;
+      to->next   = from->next;
+      (from->next != nullptr ? from->next->prev : tail) = to;
+    }
+    else
+    {
+      // the separator comes down between the two halves
+      Inner* to           = static_cast<Inner*>(left);
+      Inner* from         = static_cast<Inner*>(right);
+      to->keys[to->count] = std::move(parent->keys[slot]);
+      std::move(from->keys, from->keys + from->count, to->keys + to->count + 1);
+      std::copy(from->children, from->children + from->count + 1, to->children + to->count + 1);
+      to->count += from->count + 1;
+      from->count       = 0;
+      from->children[0] = nullptr;    // the children now belong to the left node
+    }
+    deleteTree(right);
+
+    std::move(parent->keys + slot + 1, parent->keys + parent->count, parent->keys + slot);
+    std::copy(parent->children + slot + 2, parent->children + parent->count + 1, parent->children + slot + 1);
+    parent->count--;
+  }
+
+  // moves the upper half of a full leaf into a new right sibling
+  Leaf* splitLeaf(Leaf* leaf)
+  {
+    Leaf*        right = createLeaf();
+    const size_t half  = leaf->count / 2;
+    std::move(leaf->keys + half, leaf->keys + leaf->count, right->keys);
+    right->count = leaf->count - half;
+    leaf->count  = half;
+
+    right->prev = leaf;
+    right->next = leaf->next;
+    if(leaf->next != nullptr)
+    {
+      leaf->next->prev = right;
+    }
+    else
+    {
+      tail = right;
+    }
+    leaf->next = right;
+    return right;
+  }
+
+  // places (separator, right) next to the child path[depth - 1]->children[slots[depth - 1]],
+  // splitting full inner nodes on the way up
+  void insertIntoParent(Inner** path, size_t* slots, size_t depth, T separator, Node* right)
+  {
+    while(depth > 0)
+    {
+      Inner* parent = path[--depth];
+      size_t slot   = slots[depth];
+      if(parent->count < capacity)
+      {
+        std::move_backward(parent->keys + slot, parent->keys + parent->count, parent->keys + parent->count + 1);
+        std::move_backward(parent->children + slot + 1,
+                           parent->children + parent->count + 1,
+                           parent->children + parent->count + 2);
+        parent->keys[slot]         = separator;
+        parent->children[slot + 1] = right;
+        parent->count++;
+        return;
+      }
+
+      // full: lay out the capacity + 1 keys in order, keep the lower half, push the middle key up
+      T     keys[capacity + 1];
+      Node* children[capacity + 2];
+      std::move(parent->keys, parent->keys + slot, keys);
+      keys[slot] = separator;
+      std::move(parent->keys + slot, parent->keys + capacity, keys + slot + 1);
+      std::copy(parent->children, parent->children + slot + 1, children);
+      children[slot + 1] = right;
+      std::copy(parent->children + slot + 1, parent->children + capacity + 1, children + slot + 2);
+
+      const size_t middle = (capacity + 1) / 2;
+      Inner*       split  = createInner();
+      std::move(keys, keys + middle, parent->keys);
+      std::copy(children, children + middle + 1, parent->children);
+      parent->count = middle;
+      std::move(keys + middle + 1, keys + capacity + 1, split->keys);
+      std::copy(children + middle + 1, children + capacity + 2, split->children);
+      split->count = capacity - middle;
+
+      separator = keys[middle];
+      right     = split;
+    }
+
+    // the root itself was split
+    Inner* new_root       = createInner();
+    new_root->keys[0]     = separator;
+    new_root->children[0] = root;
+    new_root->children[1] = right;
+    new_root->count       = 1;
+    root                  = new_root;
+  }
+};
+
+template <typename T, typename Allocator = std::allocator<T>, template <typename, typename> class Tree = RedBlackTree>
+class Set
+{
+  private:
+  Tree<T, Allocator> tree;
+
+  public:
+  Set(const Allocator& alloc = Allocator()) : tree(alloc) {}
+
+  // builds the set from a sorted range in O(n); duplicates are skipped
+  template <typename It>
+  static Set from_sorted(It first, It last, const Allocator& alloc = Allocator())
+  {
+    Set set(alloc);
+    set.tree.assign_sorted(first, last);
+    return set;
+  }
+
+  // adds every element of other in O(n + m)
+  void merge(const Set& other)
+  {
+    std::vector<T> merged;
+    merged.reserve(tree.size() + other.tree.size());
+    std::set_union(tree.begin(), tree.end(), other.tree.begin(), other.tree.end(), std::back_inserter(merged));
+    tree.assign_sorted(merged.begin(), merged.end());
+  }
+
+  void insert(const T& value)
+  {
+    tree.insert(value);
+  }
+
+  bool find(const T& value)
+  {
+    return tree.find(value) != tree.end();
+  }
+
+  size_t erase(const T& value)
+  {
+    return tree.erase(value);
+  }
+
+  // first element not less than value; together with upper_bound this serves range scans
+  auto lower_bound(const T& value)
+  {
+    return tree.lower_bound(value);
+  }
+
+  // first element greater than value
+  auto upper_bound(const T& value)
+  {
+    return tree.upper_bound(value);
+  }
+
+  auto equal_range(const T& value)
+  {
+    return tree.equal_range(value);
+  }
+
+  // order statistics, O(logN) with Tree = OrderStatisticTree
+  auto nth_element(size_t k)
+  {
+    return tree.nth_element(k);
+  }
+
+  size_t rank(const T& value)
+  {
+    return tree.rank(value);
+  }
+
+  size_t count_in_range(const T& first, const T& last)
+  {
+    return tree.count_in_range(first, last);
+  }
+
+  auto begin()
+  {
+    return tree.begin();
+  }
+
+  auto end()
+  {
+    return tree.end();
+  }
+
+  size_t size() const
+  {
+    return tree.size();
+  }
+};
+
+template <typename K, typename V>
+struct Pair
+{
+  K         key;
+  mutable V value;    // ordering only looks at the key, so the value stays writable through tree iterators
+
+  Pair() = default;
+
+  Pair(const K& k, const V& v) : key(k), value(v) {}
+
+  bool operator<(const Pair& rhs) const
+  {
+    return key < rhs.key;
+  }
+};
+
+template <typename K,
+          typename V,
+          typename Allocator                       = std::allocator<Pair<K, V>>,
+          template <typename, typename> class Tree = RedBlackTree>
+class Map
+{
+  private:
+  Tree<Pair<K, V>, Allocator> tree;
+
+  public:
+  Map(const Allocator& alloc = Allocator()) : tree(alloc) {}
+
+  // builds the map from a range of Pair<K, V> sorted by key in O(n); for duplicate keys the first one wins
+  template <typename It>
+  static Map from_sorted(It first, It last, const Allocator& alloc = Allocator())
+  {
+    Map map(alloc);
+    map.tree.assign_sorted(first, last);
+    return map;
+  }
+
+  // adds every key of other in O(n + m); for keys present in both, this map's value is kept
+  void merge(const Map& other)
+  {
+    std::vector<Pair<K, V>> merged;
+    merged.reserve(tree.size() + other.tree.size());
+    std::set_union(tree.begin(), tree.end(), other.tree.begin(), other.tree.end(), std::back_inserter(merged));
+    tree.assign_sorted(merged.begin(), merged.end());
+  }
+
+  void insert(const K& key, const V& value)
+  {
+    tree.insert(Pair<K, V>(key, value));
+  }
+
+  auto find(const K& key)
+  {
+    return tree.find(Pair<K, V>(key, V()));
+  }
+
+  auto lower_bound(const K& key)
+  {
+    return tree.lower_bound(Pair<K, V>(key, V()));
+  }
+
+  auto upper_bound(const K& key)
+  {
+    return tree.upper_bound(Pair<K, V>(key, V()));
+  }
+
+  auto equal_range(const K& key)
+  {
+    return tree.equal_range(Pair<K, V>(key, V()));
+  }
+
+  // order statistics over the keys, O(logN) with Tree = OrderStatisticTree
+  auto nth_element(size_t k)
+  {
+    return tree.nth_element(k);
+  }
+
+  size_t rank(const K& key)
+  {
+    return tree.rank(Pair<K, V>(key, V()));
+  }
+
+  size_t count_in_range(const K& first, const K& last)
+  {
+    return tree.count_in_range(Pair<K, V>(first, V()), Pair<K, V>(last, V()));
+  }
+
+  size_t erase(const K& key)
+  {
+    return tree.erase(Pair<K, V>(key, V()));
+  }
+
+  size_t size() const
+  {
+    return tree.size();
+  }
+
+  auto begin()
+  {
+    return tree.begin();
+  }
+
+  auto end()
+  {
+    return tree.end();
+  }
+};
+
+// search and in-order navigation over a key array in sorted or Eytzinger (BFS) order;
+// positions are array indexes, n is the past-the-end position
+template <bool Eytzinger>
+struct FlatLayout
+{
+  // position of the first key not less than value
+  template <typename T>
+  static size_t lower_bound(const T* keys, size_t n, const T& value)
+  {
+    if constexpr(Eytzinger)
+    {
+      constexpr size_t line = std::max<size_t>(64 / sizeof(T), 1);    // keys per cache line
+      size_t           k    = 1;                                      // 1-based BFS index, keys[k - 1]
+      while(k <= n)
+      {
+        __builtin_prefetch(keys + k * line - 1);    // first descendant log2(line) levels down
+        k = 2 * k + (keys[k - 1] < value);
+      }
+      k >>= std::countr_one(k) + 1;    // undo the right turns taken after the last left turn
+      return k == 0 ? n : k - 1;
+    }
+    else
+    {
+      if(n == 0)
+      {
+        return 0;
+      }
+      const T* base = keys;
+      size_t   len  = n;
+      while(len > 1)
+      {
+        const size_t half = len / 2;
+        __builtin_prefetch(base + half / 2);
+        __builtin_prefetch(base + half + half / 2);
+        base = base[half] < value ? base + half : base;
+        len -= half;
+      }
+      return static_cast<size_t>(base - keys) + (*base < value);
+    }
+  }
+
+  static size_t first(size_t n)
+  {
+    if constexpr(Eytzinger)
+    {
+      if(n == 0)
+      {
+        return 0;
+      }
+      size_t k = 1;
+      while(2 * k <= n)
+      {
+        k = 2 * k;    // leftmost node
+      }
+      return k - 1;
+    }
+    return 0;
+  }
+
+  static size_t next(size_t pos, size_t n)
+  {
+    if constexpr(Eytzinger)
+    {
+      size_t k = pos + 1;
+      if(2 * k + 1 <= n)
+      {
+        k = 2 * k + 1;    // leftmost node of the right subtree
+        while(2 * k <= n)
+        {
+          k = 2 * k;
+        }
+      }
+      else
+      {
+        k >>= std::countr_one(k) + 1;    // first ancestor reached from a left child
+      }
+      return k == 0 ? n : k - 1;
+    }
+    return pos + 1;
+  }
+
+  static size_t prev(size_t pos, size_t n)
+  {
+    if constexpr(Eytzinger)
+    {
+      size_t k = pos == n ? 0 : pos + 1;
+      if(k == 0)
+      {
+        k = 1;    // past-the-end steps back to the rightmost node
+        while(2 * k + 1 <= n)
+        {
+          k = 2 * k + 1;
+        }
+      }
+      else if(2 * k <= n)
+      {
+        k = 2 * k;    // rightmost node of the left subtree
+        while(2 * k + 1 <= n)
+        {
+          k = 2 * k + 1;
+        }
+      }
+      else
+      {
+        k >>= std::countr_zero(k) + 1;    // first ancestor reached from a right child
+      }
+      return k - 1;
+    }
+    return pos - 1;
+  }
+
+  // order[pos] is the sorted index of the key stored at pos
+  static std::vector<size_t> order(size_t n)
+  {
+    std::vector<size_t> order(n);
+    size_t              sorted = 0;
+    for(size_t pos = first(n); pos != n; pos = next(pos, n))
+    {
+      order[pos] = sorted++;
+    }
+    return order;
+  }
+
+  // lays out sorted values in this layout
+  template <typename T>
+  static std::vector<T> from_sorted(std::vector<T>&& sorted)
+  {
+    if constexpr(Eytzinger)
+    {
+      std::vector<T>            laid_out;
+      const std::vector<size_t> positions = order(sorted.size());
+      laid_out.reserve(sorted.size());
+      for(size_t sorted_index : positions)
+      {
+        laid_out.push_back(std::move(sorted[sorted_index]));
+      }
+      return laid_out;
+    }
+    return std::move(sorted);
+  }
+
+  template <typename T>
+  static std::vector<T> to_sorted(std::vector<T>&& laid_out)
+  {
+    if constexpr(Eytzinger)
+    {
+      std::vector<T> sorted;
+      sorted.reserve(laid_out.size());
+      for(size_t pos = first(laid_out.size()); pos != laid_out.size(); pos = next(pos, laid_out.size()))
+      {
+        sorted.push_back(std::move(laid_out[pos]));
+      }
+      return sorted;
+    }
+    return std::move(laid_out);
+  }
+};
+
+template <typename T, bool Eytzinger = false>
+class FlatSet
+{
+  private:
+  using Layout = FlatLayout<Eytzinger>;
+
+  std::vector<T> keys;
+
+  // merges sorted_batch into the keys and drops duplicates (existing keys win)
+  void merge_sorted(std::vector<T>&& sorted_batch)
+  {
+    std::vector<T> sorted = Layout::to_sorted(std::move(keys));
+    const size_t   old    = sorted.size();
+    sorted.insert(sorted.end(), std::make_move_iterator(sorted_batch.begin()),
+                  std::make_move_iterator(sorted_batch.end()));
+    std::inplace_merge(sorted.begin(), sorted.begin() + old, sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end(), [](const T& a, const T& b) { return !(a < b); }),
+                 sorted.end());
+    keys = Layout::from_sorted(std::move(sorted));
+  }
+
+  public:
+  class iterator
+  {
+    public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type        = T;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const T*;
+    using reference         = const T&;
+
+    iterator() = default;
+
+    iterator(const FlatSet* set, size_t pos) : set(set), pos(pos) {}
+
+    reference operator*() const
+    {
+      return set->keys[pos];
+    }
+
+    pointer operator->() const
+    {
+      return &set->keys[pos];
+    }
+
+    iterator& operator++()
+    {
+      pos = Layout::next(pos, set->keys.size());
+      return *this;
+    }
+
+    iterator operator++(int)
+    {
+      iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    iterator& operator--()
+    {
+      pos = Layout::prev(pos, set->keys.size());
+      return *this;
+    }
+
+    iterator operator--(int)
+    {
+      iterator old = *this;
+      --*this;
+      return old;
+    }
+
+    bool operator==(const iterator& other) const
+    {
+      return pos == other.pos;
+    }
+
+    private:
+    const FlatSet* set = nullptr;
+    size_t         pos = 0;
+  };
+
+  // batch insert: append, sort the batch, merge and dedupe in one pass over the keys
+  template <typename It>
+  void insert(It first, It last)
+  {
+    std::vector<T> batch(first, last);
+    std::sort(batch.begin(), batch.end());
+    merge_sorted(std::move(batch));
+  }
+
+  // O(n), prefer the batch insert
+  void insert(const T& value)
+  {
+    if(!find(value))
+    {
+      merge_sorted(std::vector<T>{value});
+    }
+  }
+
+  bool find(const T& value) const
+  {
+    const size_t pos = Layout::lower_bound(keys.data(), keys.size(), value);
+    return pos != keys.size() && !(value < keys[pos]);
+  }
+
+  // O(n)
+  size_t erase(const T& value)
+  {
+    if(!find(value))
+    {
+      return 0;
+    }
+    std::vector<T> sorted = Layout::to_sorted(std::move(keys));
+    sorted.erase(std::lower_bound(sorted.begin(), sorted.end(), value));
+    keys = Layout::from_sorted(std::move(sorted));
+    return 1;
+  }
+
+  iterator lower_bound(const T& value) const
+  {
+    return iterator(this, Layout::lower_bound(keys.data(), keys.size(), value));
+  }
+
+  iterator upper_bound(const T& value) const
+  {
+    iterator it = lower_bound(value);
+    return it != end() && !(value < *it) ? ++it : it;
+  }
+
+  iterator begin() const
+  {
+    return iterator(this, Layout::first(keys.size()));
+  }
+
+  iterator end() const
+  {
+    return iterator(this, keys.size());
+  }
+
+  size_t size() const
+  {
+    return keys.size();
+  }
+};
+
+template <typename K, typename V, bool Eytzinger = false>
+class FlatMap
+{
+  private:
+  using Layout = FlatLayout<Eytzinger>;
+
+  std::vector<K> keys;
+  std::vector<V> values;    // values[pos] belongs to keys[pos]
+
+  // merges a batch sorted by key into the map; for duplicate keys the first one (existing ones first) wins
+  void merge_sorted(std::vector<Pair<K, V>>&& sorted_batch)
+  {
+    std::vector<K>          sorted_keys   = Layout::to_sorted(std::move(keys));
+    std::vector<V>          sorted_values = Layout::to_sorted(std::move(values));
+    std::vector<Pair<K, V>> merged;
+    merged.reserve(sorted_keys.size() + sorted_batch.size());
+    for(size_t i = 0; i < sorted_keys.size(); i++)
+    {
+      merged.emplace_back(std::move(sorted_keys[i]), std::move(sorted_values[i]));
+    }
+    const size_t old = merged.size();
+    merged.insert(merged.end(), std::make_move_iterator(sorted_batch.begin()),
+                  std::make_move_iterator(sorted_batch.end()));
+    std::inplace_merge(merged.begin(), merged.begin() + old, merged.end());
+    merged.erase(std::unique(merged.begin(), merged.end(), [](const auto& a, const auto& b) { return !(a < b); }),
+                 merged.end());
+
+    sorted_keys.clear();
+    sorted_values.clear();
+    for(auto& pair : merged)
+    {
+      sorted_keys.push_back(std::move(pair.key));
+      sorted_values.push_back(std::move(pair.value));
+    }
+    keys   = Layout::from_sorted(std::move(sorted_keys));
+    values = Layout::from_sorted(std::move(sorted_values));
+  }
+
+  size_t find_pos(const K& key) const
+  {
+    const size_t pos = Layout::lower_bound(keys.data(), keys.size(), key);
+    return pos != keys.size() && !(key < keys[pos]) ? pos : keys.size();
+  }
+
+  public:
+  struct Entry
+  {
+    const K& key;
+    V&       value;
+  };
+
+  class iterator
+  {
+    struct Arrow
+    {
+      Entry entry;
+
+      const Entry* operator->() const
+      {
+        return &entry;
+      }
+    };
+
+    public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type        = Entry;
+    using difference_type   = std::ptrdiff_t;
+
+    iterator() = default;
+
+    iterator(FlatMap* map, size_t pos) : map(map), pos(pos) {}
+
+    Entry operator*() const
+    {
+      return {map->keys[pos], map->values[pos]};
+    }
+
+    Arrow operator->() const
+    {
+      return {**this};
+    }
+
+    iterator& operator++()
+    {
+      pos = Layout::next(pos, map->keys.size());
+      return *this;
+    }
+
+    iterator operator++(int)
+    {
+      iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    iterator& operator--()
+    {
+      pos = Layout::prev(pos, map->keys.size());
+      return *this;
+    }
+
+    iterator operator--(int)
+    {
+      iterator old = *this;
+      --*this;
+      return old;
+    }
+
+    bool operator==(const iterator& other) const
+    {
+      return pos == other.pos;
+    }
+
+    private:
+    FlatMap* map = nullptr;
+    size_t   pos = 0;
+  };
+
+  // batch insert of Pair<K, V>: append, sort the batch, merge and dedupe in one pass
+  template <typename It>
+  void insert(It first, It last)
+  {
+    std::vector<Pair<K, V>> batch(first, last);
+    std::stable_sort(batch.begin(), batch.end());
+    merge_sorted(std::move(batch));
+  }
+
+  // O(n), prefer the batch insert
+  void insert(const K& key, const V& value)
+  {
+    if(find_pos(key) == keys.size())
+    {
+      merge_sorted(std::vector<Pair<K, V>>{Pair<K, V>(key, value)});
+    }
+  }
+
+  iterator find(const K& key)
+  {
+    return iterator(this, find_pos(key));
+  }
+
+  // O(n)
+  size_t erase(const K& key)
+  {
+    if(find_pos(key) == keys.size())
+    {
+      return 0;
+    }
+    std::vector<K> sorted_keys   = Layout::to_sorted(std::move(keys));
+    std::vector<V> sorted_values = Layout::to_sorted(std::move(values));
+    const size_t   index         = std::lower_bound(sorted_keys.begin(), sorted_keys.end(), key) - sorted_keys.begin();
+    sorted_keys.erase(sorted_keys.begin() + index);
+    sorted_values.erase(sorted_values.begin() + index);
+    keys   = Layout::from_sorted(std::move(sorted_keys));
+    values = Layout::from_sorted(std::move(sorted_values));
+    return 1;
+  }
+
+  iterator lower_bound(const K& key)
+  {
+    return iterator(this, Layout::lower_bound(keys.data(), keys.size(), key));
+  }
+
+  iterator upper_bound(const K& key)
+  {
+    iterator it = lower_bound(key);
+    return it != end() && !(key < it->key) ? ++it : it;
+  }
+
+  iterator begin()
+  {
+    return iterator(this, Layout::first(keys.size()));
+  }
+
+  iterator end()
+  {
+    return iterator(this, keys.size());
+  }
+
+  size_t size() const
+  {
+    return keys.size();
+  }
+};
+
+int main()
+{
+  Set<int> my_set;
+  my_set.insert(5);
+  my_set.insert(3);
+  my_set.insert(7);
+  my_set.insert(9);
+  my_set.erase(5);
+  std::cout << my_set.find(5) << " " << my_set.find(7) << " " << my_set.size() << std::endl;
+
+  // all keys in [3, 9)
+  for(auto it = my_set.lower_bound(3); it != my_set.lower_bound(9); ++it)
+  {
+    std::cout << *it << ' ';
+  }
+  std::cout << std::endl;
+
+  // bulk construction from a sorted snapshot, then a linear-time union
+  std::vector<int> sorted_keys;
+  for(int i = 0; i < 1000; i += 2)
+  {
+    sorted_keys.push_back(i);
+  }
+  auto bulk_set = Set<int>::from_sorted(sorted_keys.begin(), sorted_keys.end());
+  bulk_set.merge(my_set);
+  std::cout << bulk_set.size() << " " << bulk_set.find(9) << std::endl;
+
+  // leaderboard: percentile and rank queries in O(logN)
+  Set<int, std::allocator<int>, OrderStatisticTree> scores;
+  for(int score : {70, 95, 40, 88, 62, 99, 15})
+  {
+    scores.insert(score);
+  }
+  std::cout << "median " << *scores.nth_element(scores.size() / 2) << ", rank of 88: " << scores.rank(88)
+            << ", scores in [60, 90): " << scores.count_in_range(60, 90) << std::endl;
+
+  // read-mostly data: built once in a batch, then only searched
+  FlatSet<int, true> flat_set;
+  flat_set.insert(sorted_keys.rbegin(), sorted_keys.rend());
+  std::cout << flat_set.find(500) << " " << flat_set.find(501) << " " << *flat_set.lower_bound(501) << std::endl;
+
+  FlatMap<int, std::string> flat_map;
+  std::vector<Pair<int, std::string>> entries{{3, "three"}, {1, "one"}, {2, "two"}};
+  flat_map.insert(entries.begin(), entries.end());
+  for(auto it = flat_map.begin(); it != flat_map.end(); ++it)
+  {
+    std::cout << it->key << ":" << it->value << ' ';
+  }
+  std::cout << std::endl;
+
+  Map<std::string, int> my_map;
+  my_map.insert("apple", 1);
+  my_map.insert("pear", 2);
+  my_map.find("pear")->value = 20;
+  std::cout << my_map.find("pear")->value << std::endl;
+
+  // nodes come from 4096-node chunks, and the destructor frees whole chunks
+  Set<int, NodePool<int>> pooled_set;
+  for(int i = 0; i < 100000; i++)
+  {
+    pooled_set.insert(i);
+  }
+
+  Map<int, double, NodePool<Pair<int, double>>> pooled_map;
+  pooled_map.insert(1, 1.5);
+
+  // B+-tree engine: range scan over [1000, 1010)
+  Set<int, std::allocator<int>, BTree> btree_set;
+  for(int i = 0; i < 100000; i++)
+  {
+    btree_set.insert((i * 7919) % 100000);
+  }
+  for(auto it = btree_set.lower_bound(1000); it != btree_set.end() && *it < 1010; ++it)
+  {
+    std::cout << *it << ' ';
+  }
+  std::cout << std::endl;
+
+  Map<int, double, std::allocator<Pair<int, double>>, BTree> btree_map;
+  btree_map.insert(2, 2.5);
+  btree_map.insert(1, 1.5);
+  std::cout << btree_map.find(2)->value << std::endl;
 
   return 0;
 }
@@ -1,142 +1,1437 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
 #include <forward_list>
 #include <functional>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-template <typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
-class HashTable
+/*
+HashTable has three storage engines, selected by the Engine template parameter:
+
+SeparateChaining (default):
+  -- every bucket is a std::forward_list<Key>
+  -- one heap allocation per key, and a lookup chases list nodes scattered across memory
+
+IncrementalChaining:
+  -- SeparateChaining whose growth is spread over later operations instead of one unlucky insert
+  -- on growth the old bucket array stays alive next to the new one; every insert/erase moves
+     at most migrate_step old buckets, and lookups check the old bucket until it has been moved
+
+OpenAddressing (a "Swiss table"):
+  -- keys live in one flat slot array, no allocation per key
+  -- every slot has a one-byte control word: EMPTY, DELETED, or FULL with the low 7 bits of the hash (H2)
+  -- the remaining hash bits (H1) pick a group of 16 slots; the 16 control bytes are compared against H2
+     in one SSE2 instruction (a scalar loop otherwise), so only slots whose fragment matches are compared
+  -- probing jumps to the next group (triangular sequence) until a group holding an EMPTY slot is seen
+  -- max load factor is 7/8; erase leaves a DELETED tombstone unless the group still has an EMPTY slot
+
+The stored element is Value (Key for sets, Pair<Key, T> for maps); KeyOfValue extracts its key.
+When both Hash and KeyEqual declare is_transparent, lookups accept any type they can hash and compare
+(e.g. std::string_view into a std::string-keyed table) without building a temporary Key.
+*/
+struct SeparateChaining
+{
+};
+
+struct IncrementalChaining
+{
+};
+
+struct OpenAddressing
+{
+};
+
+struct Identity
+{
+  template <typename T>
+  const T& operator()(const T& value) const
+  {
+    return value;
+  }
+};
+
+template <typename Hash, typename KeyEqual>
+concept Transparent = requires {
+  typename Hash::is_transparent;
+  typename KeyEqual::is_transparent;
+};
+
+// transparent hash for std::string keys; pair it with std::equal_to<>
+struct StringHash
+{
+  using is_transparent = void;
+
+  size_t operator()(std::string_view str) const
+  {
+    return std::hash<std::string_view>{}(str);
+  }
+};
+
+template <typename Key,
+          typename Hash       = std::hash<Key>,
+          typename KeyEqual   = std::equal_to<Key>,
+          typename Engine     = SeparateChaining,
+          typename Value      = Key,
+          typename KeyOfValue = Identity>
+class HashTable;
+
+template <typename Key, typename Hash, typename KeyEqual, typename Engine, typename Value, typename KeyOfValue>
+  requires std::is_same_v<Engine, SeparateChaining> || std::is_same_v<Engine, IncrementalChaining>
+class HashTable<Key, Hash, KeyEqual, Engine, Value, KeyOfValue>
 {
+  using Bucket = std::forward_list<Value>;
+
+  static constexpr bool   incremental  = std::is_same_v<Engine, IncrementalChaining>;
+  static constexpr size_t migrate_step = 4;    // > 1 / 0.7, so a migration ends before the next growth
+
+  template <bool IsConst>
+  class Iterator
+  {
+    using BucketPtr = std::conditional_t<IsConst, const Bucket*, Bucket*>;
+    using ListIter  = std::conditional_t<IsConst, typename Bucket::const_iterator, typename Bucket::iterator>;
+
+    public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = Value;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = std::conditional_t<IsConst, const Value*, Value*>;
+    using reference         = std::conditional_t<IsConst, const Value&, Value&>;
+
+    Iterator() = default;
+
+    // walks [bucket, last) and then [next, next_last); the second span is the new array during a migration
+    Iterator(BucketPtr bucket, BucketPtr last, ListIter iter, BucketPtr next = nullptr, BucketPtr next_last = nullptr)
+        : bucket_(bucket), last_(last), next_(next), next_last_(next_last), iter_(iter)
+    {
+      skip_empty_buckets();
+    }
+
+    operator Iterator<true>() const
+    {
+      return Iterator<true>(bucket_, last_, iter_, next_, next_last_);
+    }
+
+    reference operator*() const
+    {
+      return *iter_;
+    }
+
+    pointer operator->() const
+    {
+      return &*iter_;
+    }
+
+    Iterator& operator++()
+    {
+      ++iter_;
+      skip_empty_buckets();
+      return *this;
+    }
+
+    Iterator operator++(int)
+    {
+      Iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    bool operator==(const Iterator& other) const
+    {
+      return bucket_ == other.bucket_ && iter_ == other.iter_;
+    }
+
+    private:
+    void skip_empty_buckets()
+    {
+      while(bucket_ != last_ && iter_ == bucket_->end())
+      {
+        if(++bucket_ == last_ && next_ != next_last_)
+        {
+          bucket_ = std::exchange(next_, next_last_);
+          last_   = next_last_;
+        }
+        if(bucket_ != last_)
+        {
+          iter_ = bucket_->begin();
+        }
+      }
+      if(bucket_ == last_)
+      {
+        iter_ = ListIter{};
+      }
+    }
+
+    BucketPtr bucket_    = nullptr;
+    BucketPtr last_      = nullptr;
+    BucketPtr next_      = nullptr;
+    BucketPtr next_last_ = nullptr;
+    ListIter  iter_;
+  };
+
+  public:
+  using iterator       = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  HashTable(size_t bucket_count = 10)
+      : bucket_count_(bucket_count), element_count_(0), buckets_(bucket_count), migrate_pos_(0)
+  {
+  }
+
+  void insert(const Key& key)
+  {
+    try_emplace(key);
+  }
+
+  // constructs Value(key, args...) only if the key is absent
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+  {
+    return emplace_unique(key, std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+  {
+    return emplace_unique(std::move(key), std::forward<Args>(args)...);
+  }
+
+  bool find(const Key& key) const    // stl'find returns an iterator, and stl'count returns 1 or 0
+  {
+    return locate(key) != end();
+  }
+
+  template <typename K>
+    requires Transparent<Hash, KeyEqual>
+  bool find(const K& key) const
+  {
+    return locate(key) != end();
+  }
+
+  iterator locate(const Key& key)
+  {
+    return locate_impl(*this, key);
+  }
+
+  const_iterator locate(const Key& key) const
+  {
+    return locate_impl(*this, key);
+  }
+
+  template <typename K>
+    requires Transparent<Hash, KeyEqual>
+  iterator locate(const K& key)
+  {
+    return locate_impl(*this, key);
+  }
+
+  template <typename K>
+    requires Transparent<Hash, KeyEqual>
+  const_iterator locate(const K& key) const
+  {
+    return locate_impl(*this, key);
+  }
+
+  void erase(const Key& key)
+  {
+    erase_impl(key);
+  }
+
+  template <typename K>
+    requires Transparent<Hash, KeyEqual>
+  void erase(const K& key)
+  {
+    erase_impl(key);
+  }
+
+  // pre-sizes the buckets for n elements, so that inserting up to n elements never grows the table
+  void reserve(size_t n)
+  {
+    const size_t new_bucket_count = static_cast<size_t>(static_cast<double>(n) / 0.7) + 1;
+    if(new_bucket_count > bucket_count_)
+    {
+      rehash(new_bucket_count);
+    }
+  }
+
+  iterator begin()
+  {
+    return begin_impl(*this);
+  }
+
+  iterator end()
+  {
+    return iterator(buckets_.data() + bucket_count_, buckets_.data() + bucket_count_, {});
+  }
+
+  const_iterator begin() const
+  {
+    return begin_impl(*this);
+  }
+
+  const_iterator end() const
+  {
+    return const_iterator(buckets_.data() + bucket_count_, buckets_.data() + bucket_count_, {});
+  }
+
+  size_t size() const
+  {
+    return element_count_;
+  }
+
+  private:
+  bool migrating() const
+  {
+    return !old_buckets_.empty();
+  }
+
+  // the bucket that holds (or will hold) a key: its old bucket until that one has been migrated
+  template <typename Self, typename K>
+  static auto& home_bucket(Self& self, const K& key)
+  {
+    const size_t hash = Hash{}(key);
+    if constexpr(incremental)
+    {
+      if(self.migrating() && hash % self.old_buckets_.size() >= self.migrate_pos_)
+      {
+        return self.old_buckets_[hash % self.old_buckets_.size()];
+      }
+    }
+    return self.buckets_[hash % self.bucket_count_];
+  }
+
+  // an iterator positioned in bucket, which lives either in the old or in the current array
+  template <typename Self, typename BucketPtr, typename ListIter>
+  static auto iterator_at(Self& self, BucketPtr bucket, ListIter iter)
+  {
+    using Iter = decltype(self.end());
+
+    auto* last     = self.buckets_.data() + self.bucket_count_;
+    auto* old_last = self.old_buckets_.data() + self.old_buckets_.size();
+    if(self.migrating() && !std::less<>{}(bucket, self.old_buckets_.data()) && std::less<>{}(bucket, old_last))
+    {
+      return Iter(bucket, old_last, iter, self.buckets_.data(), last);
+    }
+    return Iter(bucket, last, iter);
+  }
+
+  template <typename Self>
+  static auto begin_impl(Self& self)
+  {
+    auto* first = self.migrating() ? self.old_buckets_.data() : self.buckets_.data();
+    return iterator_at(self, first, first->begin());
+  }
+
+  template <typename Self, typename K>
+  static auto locate_impl(Self& self, const K& key)
+  {
+    auto& bucket = home_bucket(self, key);
+    auto  iter   = std::find_if(bucket.begin(), bucket.end(), [&key](const auto& element) {
+      return KeyEqual{}(KeyOfValue{}(element), key);
+    });
+    return iter == bucket.end() ? self.end() : iterator_at(self, &bucket, iter);
+  }
+
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> emplace_unique(K&& key, Args&&... args)
+  {
+    migrate(migrate_step);
+    iterator found = locate(key);
+    if(found != end())
+    {
+      return {found, false};
+    }
+    check_load_factor();
+
+    Bucket& bucket = home_bucket(*this, key);
+    bucket.emplace_front(std::forward<K>(key), std::forward<Args>(args)...);
+    ++element_count_;
+    return {iterator_at(*this, &bucket, bucket.begin()), true};
+  }
+
+  template <typename K>
+  void erase_impl(const K& key)
+  {
+    migrate(migrate_step);
+    // take advantage of forward_list's remove_if, which returns the number of removed elements
+    element_count_ -= home_bucket(*this, key).remove_if([&key](const auto& element) {
+      return KeyEqual{}(KeyOfValue{}(element), key);
+    });
+  }
+
+  void check_load_factor()
+  {
+    double load_factor = static_cast<double>(element_count_) / static_cast<double>(bucket_count_);
+    if(load_factor > 0.7)
+    {
+      if constexpr(incremental)
+      {
+        migrate(old_buckets_.size());    // only reached if erases kept the migration from progressing
+        old_buckets_  = std::exchange(buckets_, std::vector<Bucket>(bucket_count_ * 2));
+        bucket_count_ = bucket_count_ * 2;
+        migrate_pos_  = 0;
+      }
+      else
+      {
+        rehash(bucket_count_ * 2);
+      }
+    }
+  }
+
+  // relinks the nodes of bucket into buckets_ instead of copying the elements
+  void move_nodes(Bucket& bucket)
+  {
+    while(!bucket.empty())
+    {
+      Bucket& target = buckets_[Hash{}(KeyOfValue{}(bucket.front())) % bucket_count_];
+      target.splice_after(target.before_begin(), bucket, bucket.before_begin());
+    }
+  }
+
+  // moves at most count old buckets into the current array
+  void migrate(size_t count)
+  {
+    if constexpr(incremental)
+    {
+      for(; count > 0 && migrating(); count--)
+      {
+        move_nodes(old_buckets_[migrate_pos_++]);
+        if(migrate_pos_ == old_buckets_.size())
+        {
+          std::vector<Bucket>().swap(old_buckets_);
+        }
+      }
+    }
+  }
+
+  void rehash(size_t new_bucket_count)
+  {
+    migrate(old_buckets_.size());
+    std::vector<Bucket> old_buckets = std::exchange(buckets_, std::vector<Bucket>(new_bucket_count));
+    bucket_count_                   = new_bucket_count;
+    for(auto& bucket : old_buckets)
+    {
+      move_nodes(bucket);
+    }
+  }
+
+  size_t              bucket_count_;
+  size_t              element_count_;
+  std::vector<Bucket> buckets_;
+  std::vector<Bucket> old_buckets_;    // non-empty only while an incremental migration is in progress
+  size_t              migrate_pos_;    // old buckets before this index have been moved
+};
+
+// control bytes of the Swiss table; FULL slots store H2 in [0, 127]
+enum class Ctrl : int8_t
+{
+  EMPTY   = -128,    // 0b10000000
+  DELETED = -2       // 0b11111110
+};
+
+// 16 control bytes that are probed together
+class Group
+{
+  public:
+  static constexpr size_t width = 16;
+
+#if defined(__SSE2__)
+  explicit Group(const int8_t* ctrl) : ctrl_(_mm_load_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+
+  // bit i is set if control byte i equals h2
+  uint32_t match(int8_t h2) const
+  {
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_)));
+  }
+
+  uint32_t match_empty() const
+  {
+    return match(static_cast<int8_t>(Ctrl::EMPTY));
+  }
+
+  // EMPTY and DELETED are the only negative values below -1
+  uint32_t match_empty_or_deleted() const
+  {
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl_)));
+  }
+
+  private:
+  __m128i ctrl_;
+#else
+  explicit Group(const int8_t* ctrl) : ctrl_(ctrl) {}
+
+  uint32_t match(int8_t h2) const
+  {
+    uint32_t mask = 0;
+    for(size_t i = 0; i < width; i++)
+    {
+      mask |= static_cast<uint32_t>(ctrl_[i] == h2) << i;
+    }
+    return mask;
+  }
+
+  uint32_t match_empty() const
+  {
+    return match(static_cast<int8_t>(Ctrl::EMPTY));
+  }
+
+  uint32_t match_empty_or_deleted() const
+  {
+    uint32_t mask = 0;
+    for(size_t i = 0; i < width; i++)
+    {
+      mask |= static_cast<uint32_t>(ctrl_[i] < -1) << i;
+    }
+    return mask;
+  }
+
+  private:
+  const int8_t* ctrl_;
+#endif
+};
+
+template <typename Key, typename Hash, typename KeyEqual, typename Value, typename KeyOfValue>
+class HashTable<Key, Hash, KeyEqual, OpenAddressing, Value, KeyOfValue>
+{
+  template <bool IsConst>
+  class Iterator
+  {
+    public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = Value;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = std::conditional_t<IsConst, const Value*, Value*>;
+    using reference         = std::conditional_t<IsConst, const Value&, Value&>;
+
+    Iterator() = default;
+
+    Iterator(const int8_t* ctrl, const int8_t* last, pointer slot) : ctrl_(ctrl), last_(last), slot_(slot)
+    {
+      skip_free_slots();
+    }
+
+    operator Iterator<true>() const
+    {
+      return Iterator<true>(ctrl_, last_, slot_);
+    }
+
+    reference operator*() const
+    {
+      return *slot_;
+    }
+
+    pointer operator->() const
+    {
+      return slot_;
+    }
+
+    Iterator& operator++()
+    {
+      ++ctrl_;
+      ++slot_;
+      skip_free_slots();
+      return *this;
+    }
+
+    Iterator operator++(int)
+    {
+      Iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    bool operator==(const Iterator& other) const
+    {
+      return ctrl_ == other.ctrl_;
+    }
+
+    private:
+    void skip_free_slots()
+    {
+      while(ctrl_ != last_ && *ctrl_ < 0)
+      {
+        ++ctrl_;
+        ++slot_;
+      }
+    }
+
+    const int8_t* ctrl_ = nullptr;
+    const int8_t* last_ = nullptr;
+    pointer       slot_ = nullptr;
+  };
+
+  public:
+  using iterator       = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  HashTable(size_t bucket_count = 10)
+  {
+    allocate(capacity_for(bucket_count));
+  }
+
+  HashTable(const HashTable& other)
+  {
+    allocate(other.capacity_);
+    // same capacity and hash function, so every key lands in the same slot; a control byte is copied only
+    // once its slot is built, so on a throwing copy deallocate() destroys exactly the slots built so far
+    try
+    {
+      for(size_t i = 0; i < capacity_; i++)
+      {
+        if(other.ctrl_[i] >= 0)
+        {
+          std::construct_at(slots_ + i, other.slots_[i]);
+        }
+        ctrl_[i] = other.ctrl_[i];
+      }
+    }
+    catch(...)
+    {
+      deallocate();    // the destructor does not run for a partially built object
+      throw;
+    }
+    size_        = other.size_;
+    growth_left_ = other.growth_left_;
+  }
+
+  HashTable(HashTable&& other) noexcept
+      : ctrl_(std::exchange(other.ctrl_, nullptr)),
+        slots_(std::exchange(other.slots_, nullptr)),
+        capacity_(std::exchange(other.capacity_, 0)),
+        size_(std::exchange(other.size_, 0)),
+        growth_left_(std::exchange(other.growth_left_, 0))
+  {
+  }
+
+  HashTable& operator=(HashTable other) noexcept
+  {
+    std::swap(ctrl_, other.ctrl_);
+    std::swap(slots_, other.slots_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(size_, other.size_);
+    std::swap(growth_left_, other.growth_left_);
+    return *this;
+  }
+
+  ~HashTable()
+  {
+    deallocate();
+  }
+
+  void insert(const Key& key)
+  {
+    try_emplace(key);
+  }
+
+  // constructs Value(key, args...) only if the key is absent
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+  {
+    return emplace_unique(key, std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+  {
+    return emplace_unique(std::move(key), std::forward<Args>(args)...);
+  }
+
+  bool find(const Key& key) const    // stl'find returns an iterator, and stl'count returns 1 or 0
+  {
+    return find_index(key, hash_of(key)) != capacity_;
+  }
+
+  template <typename K>
+    requires Transparent<Hash, KeyEqual>
+  bool find(const K& key) const
+  {
+    return find_index(key, hash_of(key)) != capacity_;
+  }
+
+  iterator locate(const Key& key)
+  {
+    return iterator_at(find_index(key, hash_of(key)));
+  }
+
+  const_iterator locate(const Key& key) const
+  {
+    return iterator_at(find_index(key, hash_of(key)));
+  }
+
+  template <typename K>
+    requires Transparent<Hash, KeyEqual>
+  iterator locate(const K& key)
+  {
+    return iterator_at(find_index(key, hash_of(key)));
+  }
+
+  template <typename K>
+    requires Transparent<Hash, KeyEqual>
+  const_iterator locate(const K& key) const
+  {
+    return iterator_at(find_index(key, hash_of(key)));
+  }
+
+  void erase(const Key& key)
+  {
+    erase_at(find_index(key, hash_of(key)));
+  }
+
+  template <typename K>
+    requires Transparent<Hash, KeyEqual>
+  void erase(const K& key)
+  {
+    erase_at(find_index(key, hash_of(key)));
+  }
+
+  // pre-sizes the slots for n elements, so that inserting up to n elements never grows the table
+  void reserve(size_t n)
+  {
+    if(capacity_for(n) > capacity_)
+    {
+      rehash(capacity_for(n));
+    }
+  }
+
+  iterator begin()
+  {
+    return iterator_at(0);
+  }
+
+  iterator end()
+  {
+    return iterator_at(capacity_);
+  }
+
+  const_iterator begin() const
+  {
+    return iterator_at(0);
+  }
+
+  const_iterator end() const
+  {
+    return iterator_at(capacity_);
+  }
+
+  size_t size() const
+  {
+    return size_;
+  }
+
+  private:
+  template <typename K>
+  static size_t hash_of(const K& key)
+  {
+    // std::hash of integers is the identity; mix so that H1 and H2 both see every input bit
+    size_t hash = Hash{}(key);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+  }
+
+  static int8_t h2(size_t hash)
+  {
+    return static_cast<int8_t>(hash & 0x7f);
+  }
+
+  static size_t max_load(size_t capacity)
+  {
+    return capacity - capacity / 8;
+  }
+
+  // smallest power-of-two multiple of the group width that holds n keys below the max load factor
+  static size_t capacity_for(size_t n)
+  {
+    size_t capacity = Group::width;
+    while(max_load(capacity) < n)
+    {
+      capacity *= 2;
+    }
+    return capacity;
+  }
+
+  iterator iterator_at(size_t index)
+  {
+    return iterator(ctrl_ + index, ctrl_ + capacity_, slots_ + index);
+  }
+
+  const_iterator iterator_at(size_t index) const
+  {
+    return const_iterator(ctrl_ + index, ctrl_ + capacity_, slots_ + index);
+  }
+
+  // returns capacity_ if the key is absent
+  template <typename K>
+  size_t find_index(const K& key, size_t hash) const
+  {
+    if(size_ == 0)
+    {
+      return capacity_;    // also covers a moved-from table, which owns no arrays
+    }
+    const size_t group_mask = capacity_ / Group::width - 1;
+    size_t       group      = (hash >> 7) & group_mask;
+    for(size_t step = 1;; step++)
+    {
+      const size_t base = group * Group::width;
+      Group        g(ctrl_ + base);
+      for(uint32_t mask = g.match(h2(hash)); mask != 0; mask &= mask - 1)
+      {
+        const size_t index = base + std::countr_zero(mask);
+        if(KeyEqual{}(KeyOfValue{}(slots_[index]), key))
+        {
+          return index;
+        }
+      }
+      if(g.match_empty())
+      {
+        return capacity_;
+      }
+      group = (group + step) & group_mask;    // triangular probing visits every group
+    }
+  }
+
+  // first EMPTY or DELETED slot on the probe sequence of hash
+  size_t find_insert_slot(size_t hash) const
+  {
+    const size_t group_mask = capacity_ / Group::width - 1;
+    size_t       group      = (hash >> 7) & group_mask;
+    for(size_t step = 1;; step++)
+    {
+      const uint32_t mask = Group(ctrl_ + group * Group::width).match_empty_or_deleted();
+      if(mask != 0)
+      {
+        return group * Group::width + std::countr_zero(mask);
+      }
+      group = (group + step) & group_mask;
+    }
+  }
+
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> emplace_unique(K&& key, Args&&... args)
+  {
+    const size_t hash  = hash_of(key);
+    const size_t found = find_index(key, hash);
+    if(found != capacity_)
+    {
+      return {iterator_at(found), false};
+    }
+    if(growth_left_ == 0)
+    {
+      // mostly tombstones: clean them up in place, otherwise grow
+      rehash(size_ * 2 < max_load(capacity_) ? capacity_ : capacity_for(capacity_ + 1));
+    }
+    const size_t index = find_insert_slot(hash);
+    std::construct_at(slots_ + index, std::forward<K>(key), std::forward<Args>(args)...);
+    if(ctrl_[index] == static_cast<int8_t>(Ctrl::EMPTY))
+    {
+      --growth_left_;    // reusing a tombstone does not shorten any probe sequence
+    }
+    ctrl_[index] = h2(hash);
+    ++size_;
+    return {iterator_at(index), true};
+  }
 
-  public:
-  HashTable(size_t bucket_count = 10)
-      : bucket_count_(bucket_count), element_count_(0), buckets_(bucket_count)
+  void erase_at(size_t index)
   {
+    if(index == capacity_)
+    {
+      return;
+    }
+    std::destroy_at(slots_ + index);
+    --size_;
+    // probes stop at the first group with an EMPTY slot, so if this group still has one,
+    // no probe sequence can pass through it and the slot may become EMPTY again
+    if(Group(ctrl_ + (index & ~(Group::width - 1))).match_empty())
+    {
+      ctrl_[index] = static_cast<int8_t>(Ctrl::EMPTY);
+      ++growth_left_;
+    }
+    else
+    {
+      ctrl_[index] = static_cast<int8_t>(Ctrl::DELETED);
+    }
   }
 
-  void insert(const Key& key)
+  void allocate(size_t capacity)
   {
-    check_load_factor();
+    capacity_    = capacity;
+    size_        = 0;
+    growth_left_ = max_load(capacity);
+    ctrl_        = static_cast<int8_t*>(::operator new(capacity, std::align_val_t{Group::width}));
+    slots_       = std::allocator<Value>{}.allocate(capacity);
+    std::fill(ctrl_, ctrl_ + capacity, static_cast<int8_t>(Ctrl::EMPTY));
+  }
 
-    size_t bucket_index = Hash{}(key) % bucket_count_;
-    for(const auto& element : buckets_[bucket_index])
+  void deallocate()
+  {
+    if(ctrl_ == nullptr)
+    {
+      return;
+    }
+    for(size_t i = 0; i < capacity_; i++)
     {
-      if(KeyEqual{}(element, key))
+      if(ctrl_[i] >= 0)
       {
-        return;
+        std::destroy_at(slots_ + i);
       }
     }
-    buckets_[bucket_index].push_front(key);
-    ++element_count_;
+    ::operator delete(ctrl_, std::align_val_t{Group::width});
+    std::allocator<Value>{}.deallocate(slots_, capacity_);
   }
 
-  bool find(const Key& key)    // stl'find returns an iterator, and stl'count returns 1 or 0
+  void rehash(size_t new_capacity)
   {
-    size_t bucket_index = Hash{}(key) % bucket_count_;
+    int8_t* old_ctrl     = ctrl_;
+    Value*  old_slots    = slots_;
+    size_t  old_capacity = capacity_;
+    size_t  old_size     = size_;
 
-    for(const auto& element : buckets_[bucket_index])
+    allocate(new_capacity);
+    for(size_t i = 0; i < old_capacity; i++)
     {
-      if(KeyEqual{}(element, key))
+      if(old_ctrl[i] >= 0)
       {
-        return true;
+        // keys are known to be distinct, so no equality checks are needed
+        const size_t hash  = hash_of(KeyOfValue{}(old_slots[i]));
+        const size_t index = find_insert_slot(hash);
+        ctrl_[index]       = h2(hash);
+        std::construct_at(slots_ + index, std::move(old_slots[i]));
+        std::destroy_at(old_slots + i);
       }
     }
-    return false;
+    size_ = old_size;
+    growth_left_ -= old_size;
+
+    if(old_ctrl != nullptr)
+    {
+      ::operator delete(old_ctrl, std::align_val_t{Group::width});
+      std::allocator<Value>{}.deallocate(old_slots, old_capacity);
+    }
+  }
+
+  int8_t* ctrl_;
+  Value*  slots_;
+  size_t  capacity_;
+  size_t  size_;
+  size_t  growth_left_;    // EMPTY slots that may still be filled before the max load factor is hit
+};
+
+template <typename Key,
+          typename Hash     = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>,
+          typename Engine   = SeparateChaining>
+class UnorderedSet
+{
+  private:
+  HashTable<Key, Hash, KeyEqual, Engine> table;
+
+  public:
+  void insert(const Key& key)
+  {
+    table.insert(key);
+  }
+
+  bool find(const Key& key)
+  {
+    return table.find(key);
   }
 
   void erase(const Key& key)
   {
-    size_t bucket_index = Hash{}(key) % bucket_count_;
-    // take advantage of forward_list's remove_if
-    buckets_[bucket_index].remove_if([&key](const auto& element) {
-      return KeyEqual{}(element, key);
-    });
-    --element_count_;
+    table.erase(key);
+  }
+
+  void reserve(size_t n)
+  {
+    table.reserve(n);
   }
 
   size_t size() const
   {
-    return element_count_;
+    return table.size();
   }
+};
+
+template <typename K, typename V>
+struct Pair
+{
+  K key;
+  V value;
+
+  // (key, args...) constructs the value in place; excludes copies and moves of Pair itself
+  template <typename KeyArg, typename... Args>
+    requires std::is_constructible_v<K, KeyArg&&>
+  Pair(KeyArg&& k, Args&&... args) : key(std::forward<KeyArg>(k)), value(std::forward<Args>(args)...)
+  {
+  }
+};
 
+struct PairKey
+{
+  template <typename K, typename V>
+  const K& operator()(const Pair<K, V>& pair) const
+  {
+    return pair.key;
+  }
+};
+
+template <typename Key,
+          typename T,
+          typename Hash     = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>,
+          typename Engine   = SeparateChaining>
+class UnorderedMap
+{
   private:
-  void check_load_factor()
+  using Table = HashTable<Key, Hash, KeyEqual, Engine, Pair<Key, T>, PairKey>;
+  Table table;
+
+  public:
+  using iterator       = typename Table::iterator;
+  using const_iterator = typename Table::const_iterator;
+
+  T& operator[](const Key& key)
   {
-    double load_factor = static_cast<double>(element_count_) / static_cast<double>(bucket_count_);
-    if(load_factor > 0.7)
+    return table.try_emplace(key).first->value;
+  }
+
+  T& operator[](Key&& key)
+  {
+    return table.try_emplace(std::move(key)).first->value;
+  }
+
+  // does nothing (and does not move from args) if the key is already present
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+  {
+    return table.try_emplace(key, std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+  {
+    return table.try_emplace(std::move(key), std::forward<Args>(args)...);
+  }
+
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(const Key& key, M&& value)
+  {
+    auto result = table.try_emplace(key, std::forward<M>(value));
+    if(!result.second)
     {
-      rehash(bucket_count_ * 2);
+      result.first->value = std::forward<M>(value);
     }
+    return result;
   }
 
-  void rehash(size_t new_bucket_count)
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(Key&& key, M&& value)
+  {
+    auto result = table.try_emplace(std::move(key), std::forward<M>(value));
+    if(!result.second)
+    {
+      result.first->value = std::forward<M>(value);
+    }
+    return result;
+  }
+
+  iterator find(const Key& key)
+  {
+    return table.locate(key);
+  }
+
+  const_iterator find(const Key& key) const
+  {
+    return table.locate(key);
+  }
+
+  template <typename K>
+    requires Transparent<Hash, KeyEqual>
+  iterator find(const K& key)
+  {
+    return table.locate(key);
+  }
+
+  template <typename K>
+    requires Transparent<Hash, KeyEqual>
+  const_iterator find(const K& key) const
+  {
+    return table.locate(key);
+  }
+
+  bool contains(const Key& key) const
+  {
+    return table.find(key);
+  }
+
+  template <typename K>
+    requires Transparent<Hash, KeyEqual>
+  bool contains(const K& key) const
+  {
+    return table.find(key);
+  }
+
+  size_t erase(const Key& key)
+  {
+    const size_t old_size = table.size();
+    table.erase(key);
+    return old_size - table.size();
+  }
+
+  template <typename K>
+    requires Transparent<Hash, KeyEqual>
+  size_t erase(const K& key)
+  {
+    const size_t old_size = table.size();
+    table.erase(key);
+    return old_size - table.size();
+  }
+
+  void reserve(size_t n)
+  {
+    table.reserve(n);
+  }
+
+  iterator begin()
+  {
+    return table.begin();
+  }
+
+  iterator end()
+  {
+    return table.end();
+  }
+
+  const_iterator begin() const
+  {
+    return table.begin();
+  }
+
+  const_iterator end() const
+  {
+    return table.end();
+  }
+
+  size_t size() const
+  {
+    return table.size();
+  }
+
+  bool empty() const
+  {
+    return table.size() == 0;
+  }
+};
+
+/*
+Concurrent containers: the key space is split into Shards (a power of two) by the high bits of the hash,
+and every shard is a LeftRight pair of HashTables guarded by its own writer mutex.
+
+LeftRight (left-right concurrency control):
+  -- readers never lock: they announce themselves in the reader counter of the current epoch,
+     read the replica that is currently published, and leave; a reader never waits (wait-free)
+  -- a writer applies its change to the replica that readers are not using, publishes it,
+     flips the epoch and waits until the readers of the previous epoch have left,
+     then applies the same change to the other replica
+  -- nothing is ever freed under a reader, so no separate reclamation scheme is needed;
+     the price is two copies of every key and writers that wait for in-flight reads of their shard
+*/
+template <typename Table>
+class LeftRight
+{
+  static constexpr size_t stripes = 16;    // reader counters are striped to keep readers off one cache line
+
+  struct alignas(64) Counter
+  {
+    std::atomic<size_t> value{0};
+  };
+
+  public:
+  template <typename Read>
+  auto read(Read&& read) const
+  {
+    const size_t stripe = reader_stripe();
+    const size_t epoch  = epoch_.load();
+    readers_[epoch][stripe].value.fetch_add(1);
+    auto result = read(tables_[published_.load()]);
+    readers_[epoch][stripe].value.fetch_sub(1);
+    return result;
+  }
+
+  // write is applied to both replicas, so it must be deterministic
+  template <typename Write>
+  void write(Write&& write)
+  {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    const size_t published = published_.load();
+    write(tables_[1 - published]);
+    published_.store(1 - published);
+    // readers of the previous epoch may still be on the old replica
+    const size_t epoch = epoch_.load();
+    wait_for_readers(1 - epoch);
+    epoch_.store(1 - epoch);
+    wait_for_readers(epoch);
+    write(tables_[published]);
+  }
+
+  private:
+  static size_t reader_stripe()
   {
-    std::vector<std::forward_list<Key>> new_buckets(new_bucket_count);
-    for(const auto& bucket : buckets_)
+    thread_local const size_t stripe = std::hash<std::thread::id>{}(std::this_thread::get_id()) % stripes;
+    return stripe;
+  }
+
+  void wait_for_readers(size_t epoch) const
+  {
+    for(size_t i = 0; i < stripes; i++)
     {
-      for(const auto& element : bucket)
+      while(readers_[epoch][i].value.load() != 0)
       {
-        size_t new_bucket_index = Hash{}(element) % new_bucket_count;
-        new_buckets[new_bucket_index].push_front(element);
+        std::this_thread::yield();
       }
     }
-    std::swap(new_buckets, buckets_);
-    bucket_count_ = new_bucket_count;
   }
 
-  size_t                              bucket_count_;
-  size_t                              element_count_;
-  std::vector<std::forward_list<Key>> buckets_;
+  Table               tables_[2];
+  std::atomic<size_t> published_{0};    // replica that readers use
+  std::atomic<size_t> epoch_{0};        // reader counters that new readers announce themselves in
+  mutable Counter     readers_[2][stripes];
+  std::mutex          writer_mutex_;
 };
 
-template <typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
-class UnorderedSet
+// picks a shard from the high bits of the mixed hash, so shards and buckets use different bits
+template <size_t Shards>
+size_t shard_of(size_t hash)
+{
+  static_assert(Shards > 0 && (Shards & (Shards - 1)) == 0, "Shards must be a power of two");
+  if constexpr(Shards == 1)
+  {
+    return 0;
+  }
+  else
+  {
+    return (hash * 0x9e3779b97f4a7c15ULL) >> (64 - std::countr_zero(Shards));
+  }
+}
+
+template <typename Key,
+          typename Hash     = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>,
+          typename Engine   = SeparateChaining,
+          size_t Shards     = 64>
+class ConcurrentUnorderedSet
 {
   private:
-  HashTable<Key, Hash, KeyEqual> table;
+  using Shard = LeftRight<HashTable<Key, Hash, KeyEqual, Engine>>;
+  std::unique_ptr<Shard[]> shards = std::make_unique<Shard[]>(Shards);
+
+  Shard& shard(const Key& key) const
+  {
+    return shards[shard_of<Shards>(Hash{}(key))];
+  }
 
   public:
   void insert(const Key& key)
   {
-    table.insert(key);
+    shard(key).write([&key](auto& table) { table.insert(key); });
   }
 
-  bool find(const Key& key)
+  bool find(const Key& key) const
   {
-    return table.find(key);
+    return shard(key).read([&key](const auto& table) { return table.find(key); });
   }
 
   void erase(const Key& key)
   {
-    table.erase(key);
+    shard(key).write([&key](auto& table) { table.erase(key); });
   }
 
+  // a snapshot that may be stale while writers are active
   size_t size() const
   {
-    return table.size();
+    size_t size = 0;
+    for(size_t i = 0; i < Shards; i++)
+    {
+      size += shards[i].read([](const auto& table) { return table.size(); });
+    }
+    return size;
   }
 };
 
-template <typename Key, typename Value>
-struct Pair
+template <typename Key,
+          typename T,
+          typename Hash     = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>,
+          typename Engine   = SeparateChaining,
+          size_t Shards     = 64>
+class ConcurrentUnorderedMap
 {
-  using Key = Key;
-  Key   key;
-  Value value;
+  private:
+  using Shard = LeftRight<HashTable<Key, Hash, KeyEqual, Engine, Pair<Key, T>, PairKey>>;
+  std::unique_ptr<Shard[]> shards = std::make_unique<Shard[]>(Shards);
+
+  Shard& shard(const Key& key) const
+  {
+    return shards[shard_of<Shards>(Hash{}(key))];
+  }
+
+  public:
+  void insert_or_assign(const Key& key, const T& value)
+  {
+    shard(key).write([&](auto& table) {
+      auto result = table.try_emplace(key, value);
+      if(!result.second)
+      {
+        result.first->value = value;
+      }
+    });
+  }
+
+  void try_emplace(const Key& key, const T& value)
+  {
+    shard(key).write([&](auto& table) { table.try_emplace(key, value); });
+  }
+
+  // returns a copy: a reference could be overwritten by the next writer
+  std::optional<T> find(const Key& key) const
+  {
+    return shard(key).read([&key](const auto& table) -> std::optional<T> {
+      auto it = table.locate(key);
+      if(it == table.end())
+      {
+        return std::nullopt;
+      }
+      return it->value;
+    });
+  }
+
+  bool contains(const Key& key) const
+  {
+    return shard(key).read([&key](const auto& table) { return table.find(key); });
+  }
+
+  void erase(const Key& key)
+  {
+    shard(key).write([&key](auto& table) { table.erase(key); });
+  }
 
-  Pair(const Key& k, const Value& v) : key(k), value(v) {}
+  // a snapshot that may be stale while writers are active
+  size_t size() const
+  {
+    size_t size = 0;
+    for(size_t i = 0; i < Shards; i++)
+    {
+      size += shards[i].read([](const auto& table) { return table.size(); });
+    }
+    return size;
+  }
 };
 
-template <
-    typename Pair,
-    typename Hash     = std::hash<Pair::Key>,
-    typename KeyEqual = std::equal_to<Pair::Key>>
-class UnorderedMap
+// throughput of the sharded set against one HashTable behind a global mutex,
+// sweeping thread count and the share of reads
+void benchmark_concurrent()
 {
-  private:
-  HashTable<Pair, Hash, KeyEqual> table;
-};
+  constexpr size_t key_range      = 1 << 16;
+  constexpr size_t ops_per_thread = 200000;
+
+  struct LockedSet
+  {
+    HashTable<int> table;
+    std::mutex     mutex;
+
+    void insert(int key)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      table.insert(key);
+    }
+
+    bool find(int key)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      return table.find(key);
+    }
+
+    void erase(int key)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      table.erase(key);
+    }
+  };
+
+  auto run = [&](auto& set, size_t threads, int read_percent) {
+    for(size_t key = 0; key < key_range; key += 2)
+    {
+      set.insert(static_cast<int>(key));
+    }
+    std::atomic<size_t>      hits{0};
+    std::vector<std::thread> workers;
+    auto                     start = std::chrono::steady_clock::now();
+    for(size_t t = 0; t < threads; t++)
+    {
+      workers.emplace_back([&, t] {
+        std::mt19937 rng(static_cast<unsigned>(t));
+        size_t       local_hits = 0;
+        for(size_t i = 0; i < ops_per_thread; i++)
+        {
+          const int key = static_cast<int>(rng() % key_range);
+          const int op  = static_cast<int>(rng() % 100);
+          if(op < read_percent)
+          {
+            local_hits += set.find(key);
+          }
+          else if(op % 2 == 0)
+          {
+            set.insert(key);
+          }
+          else
+          {
+            set.erase(key);
+          }
+        }
+        hits += local_hits;
+      });
+    }
+    for(auto& worker : workers)
+    {
+      worker.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(threads * ops_per_thread) / elapsed.count() / 1e6;
+  };
+
+  const size_t max_threads = std::max<size_t>(4, std::thread::hardware_concurrency());
+  std::cout << "threads  read%  global mutex (Mops/s)  sharded left-right (Mops/s)" << std::endl;
+  for(int read_percent : {100, 95, 50})
+  {
+    for(size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+      LockedSet                   locked;
+      ConcurrentUnorderedSet<int> sharded;
+      const double                locked_mops  = run(locked, threads, read_percent);
+      const double                sharded_mops = run(sharded, threads, read_percent);
+      std::cout << threads << "\t " << read_percent << "\t" << locked_mops << "\t\t\t" << sharded_mops << std::endl;
+    }
+  }
+}
 
-int main()
+int main(int argc, char** argv)
 {
   auto set = HashTable<int>();
   set.insert(19);
@@ -144,4 +1439,68 @@ int main()
   set.insert(3);
   set.erase(5);
   std::cout << set.find(5) << " " << set.size() << std::endl;
+
+  UnorderedSet<int, std::hash<int>, std::equal_to<int>, OpenAddressing> flat_set;
+  for(int i = 0; i < 1000; i++)
+  {
+    flat_set.insert(i);
+  }
+  for(int i = 0; i < 1000; i += 2)
+  {
+    flat_set.erase(i);
+  }
+  std::cout << flat_set.find(998) << " " << flat_set.find(999) << " " << flat_set.size() << std::endl;
+
+  // growth is spread over the following inserts/erases instead of one full rebuild
+  UnorderedSet<int, std::hash<int>, std::equal_to<int>, IncrementalChaining> incremental_set;
+  for(int i = 0; i < 1000; i++)
+  {
+    incremental_set.insert(i);
+  }
+  std::cout << incremental_set.find(500) << " " << incremental_set.size() << std::endl;
+
+  // or skip growth entirely
+  UnorderedSet<int> reserved_set;
+  reserved_set.reserve(1000);
+
+  // std::string keys probed with std::string_view: no temporary std::string per lookup
+  UnorderedMap<std::string, int, StringHash, std::equal_to<>, OpenAddressing> cache;
+  cache["alpha"] = 1;
+  cache.try_emplace("beta", 2);
+  cache.try_emplace("beta", 20);    // already present, no effect
+  cache.insert_or_assign("gamma", 3);
+  cache.insert_or_assign("gamma", 30);
+  cache.erase(std::string_view("alpha"));
+  std::string_view probe = "gamma";
+  if(auto it = cache.find(probe); it != cache.end())
+  {
+    std::cout << it->key << " " << it->value << std::endl;
+  }
+  for(const auto& [key, value] : cache)
+  {
+    std::cout << key << ":" << value << " ";
+  }
+  std::cout << cache.size() << std::endl;
+
+  ConcurrentUnorderedMap<int, std::string> shared_cache;
+  std::vector<std::thread> writers;
+  for(int t = 0; t < 4; t++)
+  {
+    writers.emplace_back([&shared_cache, t] {
+      for(int i = t; i < 1000; i += 4)
+      {
+        shared_cache.insert_or_assign(i, std::to_string(i));
+      }
+    });
+  }
+  for(auto& writer : writers)
+  {
+    writer.join();
+  }
+  std::cout << shared_cache.find(42).value_or("missing") << " " << shared_cache.size() << std::endl;
+
+  if(argc > 1 && std::string_view(argv[1]) == "--bench")
+  {
+    benchmark_concurrent();
+  }
 }
\ No newline at end of file
@@ -1,67 +1,568 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+Vector<T, Growth, Alignment, HugeThreshold>:
+  -- storage is raw memory; only the first size_ slots hold constructed elements,
+     so growing never default-constructs the spare capacity
+  -- growth relocates elements with std::move_if_noexcept (a throwing move falls back to a copy, which
+     keeps push_back's strong exception guarantee), or with a single memcpy for trivially copyable T
+  -- emplace_back constructs the new element before relocating, so v.push_back(v[0]) is safe
+  -- Growth picks the next capacity: DoublingGrowth (default), HalfAgainGrowth (1.5x, at most a third of
+     the buffer is slack) or ChunkGrowth<Elements> (linear, for buffers whose final size is roughly known)
+  -- the buffer is aligned to Alignment bytes (e.g. 64 for cache-line / AVX-512 aligned loads)
+  -- buffers of at least HugeThreshold bytes (0 = never) are mmap()ed in whole 2 MiB pages with
+     madvise(MADV_HUGEPAGE), and a trivially copyable T grows them with mremap(): the kernel moves
+     the page mappings, no element is copied (Linux only)
+
+SmallVector<T, N>:
+  -- same API as Vector, but the first N elements live in a buffer inside the object;
+     only growing past N allocates, so short vectors never touch the heap
+  -- capacity starts at N and doubles from there; shrink_to_fit moves a small enough heap buffer back inline
+  -- moving a heap-backed SmallVector steals the buffer, moving an inline one moves the elements
+
+MmapVector<T>:
+  -- a Vector of trivially copyable T whose storage is a shared mapping of a file, laid out as a 64 byte
+     header (magic, format version, element size, size, capacity) followed by capacity elements
+  -- opening an existing file maps it and checks the header: no parsing, no copy, elements are paged
+     in on first touch; a missing file is created empty
+  -- growth doubles capacity with ftruncate() and mremap(); the header lives in the mapping, so size
+     is always current in the page cache, and flush() msync()s it to disk for durability (Linux only)
+
+SIMD bulk algorithms (simd_fill, simd_sum, simd_min, simd_max, simd_find, simd_count, simd_transform, simd_copy):
+  -- work on any of the containers above holding an arithmetic T
+  -- each kernel is written once over GCC vector extensions (SimdOps<T, Bytes>) and instantiated for
+     64, 32 and 16 byte vectors inside AVX-512F, AVX2 and SSE2 entry points; the widest level the CPU
+     reports through CPUID is picked once at startup, with a scalar fallback off x86
+  -- sums and floating point min/max combine lanes in a different order than a loop would:
+     float sums may round differently, and NaNs are not propagated
+  -- simd_copy is memcpy, which glibc already dispatches on the same CPU features
+
+constexpr:
+  -- Array is an aggregate usable in constant expressions: brace initialization, iterators, fill,
+     ==/<=> and structured bindings, so lookup tables can be computed by the compiler
+  -- Vector works during constant evaluation too (C++20 transient allocation): there it allocates
+     through std::allocator and constructs element by element, so a constexpr function can build a
+     Vector as scratch space and copy the result into an Array; the buffer must be freed before the
+     constant expression ends
+*/
+
+// constructs from[0, n) into the raw storage at to; from is left for the caller to destroy
 template <typename T>
+constexpr void relocate(T* from, size_t n, T* to)
+{
+  if constexpr(std::is_trivially_copyable_v<T>)
+  {
+    if(!std::is_constant_evaluated())
+    {
+      if(n > 0)
+      {
+        std::memcpy(to, from, n * sizeof(T));
+      }
+      return;
+    }
+  }
+  size_t i = 0;
+  try
+  {
+    for(; i < n; i++)
+    {
+      std::construct_at(to + i, std::move_if_noexcept(from[i]));
+    }
+  }
+  catch(...)
+  {
+    std::destroy_n(to, i);
+    throw;
+  }
+}
+
+struct DoublingGrowth
+{
+  static constexpr size_t next(size_t capacity)
+  {
+    return capacity == 0 ? 1 : 2 * capacity;
+  }
+};
+
+struct HalfAgainGrowth
+{
+  static constexpr size_t next(size_t capacity)
+  {
+    return capacity + capacity / 2 + 1;
+  }
+};
+
+template <size_t Elements>
+struct ChunkGrowth
+{
+  static_assert(Elements > 0);
+
+  static constexpr size_t next(size_t capacity)
+  {
+    return capacity + Elements;
+  }
+};
+
+template <typename T, typename Growth = DoublingGrowth, size_t Alignment = alignof(T), size_t HugeThreshold = 0>
 class Vector
 {
+  static_assert(std::has_single_bit(Alignment) && Alignment >= alignof(T), "alignment must be a power of two");
+#ifdef __linux__
+  static_assert(HugeThreshold == 0 || Alignment <= 4096, "mapped buffers are only page aligned");
+#else
+  static_assert(HugeThreshold == 0, "mapped buffers need mmap/mremap");
+#endif
+
   private:
   T*     data_;
   size_t size_;
   size_t capacity_;
 
   public:
-  Vector() : data_(nullptr), size_(0), capacity_(0) {}
+  using value_type = T;
+
+  private:
+  static constexpr size_t huge_page_size = size_t(2) << 20;
+
+  // never during constant evaluation: compile-time buffers come from std::allocator
+  static constexpr bool mapped(size_t capacity)
+  {
+    return HugeThreshold != 0 && !std::is_constant_evaluated() && capacity * sizeof(T) >= HugeThreshold;
+  }
+
+  static size_t mapped_bytes(size_t capacity)
+  {
+    return (capacity * sizeof(T) + huge_page_size - 1) & ~(huge_page_size - 1);
+  }
+
+  // a mapped buffer rounds capacity up to fill its last huge page
+  static constexpr T* allocate(size_t& capacity)
+  {
+    if(capacity == 0)
+    {
+      return nullptr;
+    }
+    if(std::is_constant_evaluated())
+    {
+      return std::allocator<T>().allocate(capacity);
+    }
+#ifdef __linux__
+    if(mapped(capacity))
+    {
+      const size_t bytes = mapped_bytes(capacity);
+      void*        data  = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if(data == MAP_FAILED)
+      {
+        throw std::bad_alloc();
+      }
+      madvise(data, bytes, MADV_HUGEPAGE);    // only a hint: fails harmlessly when transparent huge pages are off
+      capacity = bytes / sizeof(T);
+      return static_cast<T*>(data);
+    }
+#endif
+    if constexpr(Alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    {
+      return static_cast<T*>(::operator new(capacity * sizeof(T), std::align_val_t(Alignment)));
+    }
+    else
+    {
+      return static_cast<T*>(::operator new(capacity * sizeof(T)));
+    }
+  }
+
+  static constexpr void deallocate(T* data, size_t capacity)
+  {
+    if(data == nullptr)
+    {
+      return;
+    }
+    if(std::is_constant_evaluated())
+    {
+      std::allocator<T>().deallocate(data, capacity);
+      return;
+    }
+#ifdef __linux__
+    if(mapped(capacity))
+    {
+      munmap(data, mapped_bytes(capacity));
+      return;
+    }
+#endif
+    if constexpr(Alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    {
+      ::operator delete(data, std::align_val_t(Alignment));
+    }
+    else
+    {
+      ::operator delete(data);
+    }
+  }
+
+  constexpr void reallocate(size_t new_capacity)
+  {
+#ifdef __linux__
+    if constexpr(std::is_trivially_copyable_v<T>)
+    {
+      if(mapped(capacity_) && mapped(new_capacity))
+      {
+        const size_t bytes = mapped_bytes(new_capacity);
+        void*        data  = mremap(data_, mapped_bytes(capacity_), bytes, MREMAP_MAYMOVE);
+        if(data == MAP_FAILED)
+        {
+          throw std::bad_alloc();
+        }
+        data_     = static_cast<T*>(data);
+        capacity_ = bytes / sizeof(T);
+        return;
+      }
+    }
+#endif
+    T* new_data_ = allocate(new_capacity);
+    try
+    {
+      relocate(data_, size_, new_data_);
+    }
+    catch(...)
+    {
+      deallocate(new_data_, new_capacity);
+      throw;
+    }
+    std::destroy_n(data_, size_);
+    deallocate(data_, capacity_);
+    data_     = new_data_;
+    capacity_ = new_capacity;
+  }
+
+  public:
+  constexpr Vector() : data_(nullptr), size_(0), capacity_(0) {}
+
+  // the loops count size_ up as they go, so a throwing constructor leaves the destructor a valid state
+  constexpr Vector(size_t n_) : Vector()
+  {
+    reserve(n_);
+    for(; size_ < n_; size_++)
+    {
+      std::construct_at(data_ + size_);
+    }
+  }
+
+  constexpr Vector(const Vector& other) : Vector()
+  {
+    reserve(other.size_);
+    for(; size_ < other.size_; size_++)
+    {
+      std::construct_at(data_ + size_, other.data_[size_]);
+    }
+  }
 
-  Vector(size_t n_) : size_(n_), capacity_(n_)
+  constexpr Vector(Vector&& other) noexcept
+      : data_(std::exchange(other.data_, nullptr)),
+        size_(std::exchange(other.size_, 0)),
+        capacity_(std::exchange(other.capacity_, 0))
   {
-    data_ = new T[n_];
   }
 
-  ~Vector()
+  constexpr Vector& operator=(const Vector& other)
   {
-    delete[] data_;
+    if(this != &other)
+    {
+      Vector copy(other);
+      swap(copy);
+    }
+    return *this;
+  }
+
+  constexpr Vector& operator=(Vector&& other) noexcept
+  {
+    if(this != &other)
+    {
+      Vector moved(std::move(other));
+      swap(moved);
+    }
+    return *this;
+  }
+
+  constexpr ~Vector()
+  {
+    std::destroy_n(data_, size_);
+    deallocate(data_, capacity_);
   };
 
-  T& operator[](size_t index)
+  constexpr void swap(Vector& other) noexcept
+  {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(capacity_, other.capacity_);
+  }
+
+  constexpr T& operator[](size_t index)
   {
     return data_[index];
   }
 
-  const T& operator[](size_t index) const
+  constexpr const T& operator[](size_t index) const
   {
     return data_[index];
   }
 
-  size_t size() const
+  constexpr T* data()
+  {
+    return data_;
+  }
+
+  constexpr const T* data() const
+  {
+    return data_;
+  }
+
+  constexpr size_t size() const
   {
     return size_;
   }
 
-  void push_back(const T& value)
+  constexpr size_t capacity() const
   {
-    if(size_ == capacity_)
+    return capacity_;
+  }
+
+  constexpr void reserve(size_t new_capacity)
+  {
+    if(new_capacity > capacity_)
+    {
+      reallocate(new_capacity);
+    }
+  }
+
+  constexpr void shrink_to_fit()
+  {
+    if(capacity_ > size_)
     {
-      capacity_    = size_ == 0 ? 1 : 2 * capacity_;
-      T* new_data_ = new T[capacity_];
+      reallocate(size_);
+    }
+  }
 
-      for(size_t i = 0; i < size_; i++)
+  template <typename... Args>
+  constexpr T& emplace_back(Args&&... args)
+  {
+    if(size_ == capacity_)
+    {
+      size_t new_capacity = Growth::next(capacity_);
+      if constexpr(HugeThreshold != 0 && std::is_trivially_copyable_v<T>)
+      {
+        if(mapped(capacity_) && mapped(new_capacity))
+        {
+          T value(std::forward<Args>(args)...);    // args may refer to an element: copy it out before the remap
+          reallocate(new_capacity);
+          std::construct_at(data_ + size_, value);
+          return data_[size_++];
+        }
+      }
+      T* new_data_ = allocate(new_capacity);
+      try
+      {
+        // args may refer to an element of this vector: construct before the old elements move away
+        std::construct_at(new_data_ + size_, std::forward<Args>(args)...);
+      }
+      catch(...)
+      {
+        deallocate(new_data_, new_capacity);
+        throw;
+      }
+      try
+      {
+        relocate(data_, size_, new_data_);
+      }
+      catch(...)
       {
-        new_data_[i] = data_[i];
+        std::destroy_at(new_data_ + size_);
+        deallocate(new_data_, new_capacity);
+        throw;
       }
-      delete[] data_;
-      data_ = new_data_;
+      std::destroy_n(data_, size_);
+      deallocate(data_, capacity_);
+      data_     = new_data_;
+      capacity_ = new_capacity;
+    }
+    else
+    {
+      std::construct_at(data_ + size_, std::forward<Args>(args)...);
     }
-    data_[size_] = value;
-    size_++;
+    return data_[size_++];
+  }
+
+  constexpr void push_back(const T& value)
+  {
+    emplace_back(value);
+  }
+
+  constexpr void push_back(T&& value)
+  {
+    emplace_back(std::move(value));
   }
 };
 
-template <typename T, size_t size_>
-class Array
+template <typename T, size_t N>
+class SmallVector
 {
+  static_assert(N > 0, "use Vector for N == 0");
+
   private:
-  T data_[size_];
+  T*     data_;
+  size_t size_;
+  size_t capacity_;
+  alignas(T) unsigned char inline_[N * sizeof(T)];
+
+  public:
+  using value_type = T;
+
+  private:
+  T* inline_data()
+  {
+    return reinterpret_cast<T*>(inline_);
+  }
+
+  bool is_inline() const
+  {
+    return data_ == reinterpret_cast<const T*>(inline_);
+  }
+
+  static T* allocate(size_t n)
+  {
+    return std::allocator<T>().allocate(n);
+  }
+
+  // destroys the elements and frees the heap buffer, if any
+  void release()
+  {
+    std::destroy_n(data_, size_);
+    if(!is_inline())
+    {
+      std::allocator<T>().deallocate(data_, capacity_);
+    }
+  }
+
+  // capacities up to N go back to the inline buffer
+  void reallocate(size_t new_capacity)
+  {
+    const bool to_inline = new_capacity <= N;
+    T*         new_data_ = to_inline ? inline_data() : allocate(new_capacity);
+    try
+    {
+      relocate(data_, size_, new_data_);
+    }
+    catch(...)
+    {
+      if(!to_inline)
+      {
+        std::allocator<T>().deallocate(new_data_, new_capacity);
+      }
+      throw;
+    }
+    release();
+    data_     = new_data_;
+    capacity_ = to_inline ? N : new_capacity;
+  }
+
+  // this must be empty and inline
+  void take(SmallVector& other)
+  {
+    if(other.is_inline())
+    {
+      std::uninitialized_move_n(other.data_, other.size_, data_);
+      size_ = other.size_;
+      std::destroy_n(other.data_, other.size_);
+      other.size_ = 0;
+    }
+    else
+    {
+      data_     = std::exchange(other.data_, other.inline_data());
+      size_     = std::exchange(other.size_, 0);
+      capacity_ = std::exchange(other.capacity_, N);
+    }
+  }
 
   public:
+  SmallVector() : data_(inline_data()), size_(0), capacity_(N) {}
+
+  SmallVector(size_t n_) : SmallVector()
+  {
+    reserve(n_);
+    std::uninitialized_value_construct_n(data_, n_);
+    size_ = n_;
+  }
+
+  SmallVector(const SmallVector& other) : SmallVector()
+  {
+    reserve(other.size_);
+    std::uninitialized_copy_n(other.data_, other.size_, data_);
+    size_ = other.size_;
+  }
+
+  SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) : SmallVector()
+  {
+    take(other);
+  }
+
+  SmallVector& operator=(const SmallVector& other)
+  {
+    if(this != &other)
+    {
+      SmallVector copy(other);
+      swap(copy);
+    }
+    return *this;
+  }
+
+  SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+  {
+    if(this != &other)
+    {
+      release();
+      data_     = inline_data();
+      size_     = 0;
+      capacity_ = N;
+      take(other);
+    }
+    return *this;
+  }
+
+  ~SmallVector()
+  {
+    release();
+  }
+
+  void swap(SmallVector& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+  {
+    SmallVector moved(std::move(other));
+    other = std::move(*this);
+    *this = std::move(moved);
+  }
+
   T& operator[](size_t index)
   {
     return data_[index];
@@ -72,24 +573,1028 @@ class Array
     return data_[index];
   }
 
+  T* data()
+  {
+    return data_;
+  }
+
+  const T* data() const
+  {
+    return data_;
+  }
+
   size_t size() const
   {
     return size_;
   }
-};
 
-int main()
-{
-  Vector<int> vec;
-  vec.push_back(10);
-  vec.push_back(2);
-  for(int i = 0; i < vec.size(); i++)
-    std::cout << vec[i] << '\n';
+  size_t capacity() const
+  {
+    return capacity_;
+  }
 
-  Array<int, 3> arr{};
-  arr[1] = 9;
-  for(int i = 0; i < arr.size(); i++)
-    std::cout << arr[i] << '\n';
+  void reserve(size_t new_capacity)
+  {
+    if(new_capacity > capacity_)
+    {
+      reallocate(new_capacity);
+    }
+  }
+
+  void shrink_to_fit()
+  {
+    if(!is_inline() && capacity_ > size_)
+    {
+      reallocate(size_);
+    }
+  }
 
+  template <typename... Args>
+  T& emplace_back(Args&&... args)
+  {
+    if(size_ == capacity_)
+    {
+      const size_t new_capacity = 2 * capacity_;
+      T*           new_data_    = allocate(new_capacity);
+      try
+      {
+        // args may refer to an element of this vector: construct before the old elements move away
+        ::new(static_cast<void*>(new_data_ + size_)) T(std::forward<Args>(args)...);
+      }
+      catch(...)
+      {
+        std::allocator<T>().deallocate(new_data_, new_capacity);
+        throw;
+      }
+      try
+      {
+        relocate(data_, size_, new_data_);
+      }
+      catch(...)
+      {
+        std::destroy_at(new_data_ + size_);
+        std::allocator<T>().deallocate(new_data_, new_capacity);
+        throw;
+      }
+      release();
+      data_     = new_data_;
+      capacity_ = new_capacity;
+    }
+    else
+    {
+      ::new(static_cast<void*>(data_ + size_)) T(std::forward<Args>(args)...);
+    }
+    return data_[size_++];
+  }
+
+  void push_back(const T& value)
+  {
+    emplace_back(value);
+  }
+
+  void push_back(T&& value)
+  {
+    emplace_back(std::move(value));
+  }
+};
+
+#ifdef __linux__
+template <typename T>
+class MmapVector
+{
+  static_assert(std::is_trivially_copyable_v<T>, "elements are stored as raw bytes");
+
+  private:
+  struct Header
+  {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t element_size;
+    uint64_t size;
+    uint64_t capacity;
+  };
+
+  static constexpr uint64_t magic_number   = 0x524f54434556564d;    // "MVVECTOR"
+  static constexpr uint32_t format_version = 1;
+  static constexpr size_t   data_offset    = 64;                    // header, padded to a cache line
+
+  static_assert(sizeof(Header) <= data_offset && alignof(T) <= data_offset);
+
+  int     fd_;
+  Header* header_;    // start of the mapping
+  size_t  mapped_bytes_;
+
+  [[noreturn]] static void fail(const char* what)
+  {
+    throw std::system_error(errno, std::generic_category(), what);
+  }
+
+  static size_t file_bytes(size_t capacity)
+  {
+    return data_offset + capacity * sizeof(T);
+  }
+
+  void grow(size_t new_capacity)
+  {
+    const size_t bytes = file_bytes(new_capacity);
+    if(ftruncate(fd_, static_cast<off_t>(bytes)) != 0)    // new pages read as zeros
+    {
+      fail("MmapVector: ftruncate");
+    }
+    void* mapping = mremap(header_, mapped_bytes_, bytes, MREMAP_MAYMOVE);
+    if(mapping == MAP_FAILED)
+    {
+      fail("MmapVector: mremap");
+    }
+    header_           = static_cast<Header*>(mapping);
+    mapped_bytes_     = bytes;
+    header_->capacity = new_capacity;
+  }
+
+  public:
+  using value_type = T;
+
+  explicit MmapVector(const char* path) : fd_(open(path, O_RDWR | O_CREAT, 0644)), header_(nullptr), mapped_bytes_(0)
+  {
+    if(fd_ < 0)
+    {
+      fail("MmapVector: open");
+    }
+    try
+    {
+      struct stat st;
+      if(fstat(fd_, &st) != 0)
+      {
+        fail("MmapVector: fstat");
+      }
+      const bool created = st.st_size == 0;
+      if(created && ftruncate(fd_, data_offset) != 0)
+      {
+        fail("MmapVector: ftruncate");
+      }
+      mapped_bytes_ = created ? data_offset : static_cast<size_t>(st.st_size);
+      if(mapped_bytes_ < data_offset)
+      {
+        throw std::runtime_error("MmapVector: file too short for a header");
+      }
+      void* mapping = mmap(nullptr, mapped_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+      if(mapping == MAP_FAILED)
+      {
+        fail("MmapVector: mmap");
+      }
+      header_ = static_cast<Header*>(mapping);
+      if(created)
+      {
+        *header_ = Header{magic_number, format_version, sizeof(T), 0, 0};
+      }
+      else if(header_->magic != magic_number || header_->version != format_version
+              || header_->element_size != sizeof(T) || header_->size > header_->capacity
+              || file_bytes(header_->capacity) > mapped_bytes_)
+      {
+        throw std::runtime_error("MmapVector: not a vector file of this element type");
+      }
+    }
+    catch(...)
+    {
+      if(header_ != nullptr)
+      {
+        munmap(header_, mapped_bytes_);
+      }
+      close(fd_);
+      throw;
+    }
+  }
+
+  MmapVector(MmapVector&& other) noexcept
+      : fd_(std::exchange(other.fd_, -1)),
+        header_(std::exchange(other.header_, nullptr)),
+        mapped_bytes_(std::exchange(other.mapped_bytes_, 0))
+  {
+  }
+
+  MmapVector& operator=(MmapVector&& other) noexcept
+  {
+    if(this != &other)
+    {
+      MmapVector moved(std::move(other));
+      std::swap(fd_, moved.fd_);
+      std::swap(header_, moved.header_);
+      std::swap(mapped_bytes_, moved.mapped_bytes_);
+    }
+    return *this;
+  }
+
+  MmapVector(const MmapVector&)            = delete;
+  MmapVector& operator=(const MmapVector&) = delete;
+
+  // unmapping keeps every write in the page cache; call flush() first to wait for the disk
+  ~MmapVector()
+  {
+    if(header_ != nullptr)
+    {
+      munmap(header_, mapped_bytes_);
+    }
+    if(fd_ >= 0)
+    {
+      close(fd_);
+    }
+  }
+
+  T& operator[](size_t index)
+  {
+    return data()[index];
+  }
+
+  const T& operator[](size_t index) const
+  {
+    return data()[index];
+  }
+
+  T* data()
+  {
+    return reinterpret_cast<T*>(reinterpret_cast<char*>(header_) + data_offset);
+  }
+
+  const T* data() const
+  {
+    return reinterpret_cast<const T*>(reinterpret_cast<const char*>(header_) + data_offset);
+  }
+
+  size_t size() const
+  {
+    return header_->size;
+  }
+
+  size_t capacity() const
+  {
+    return header_->capacity;
+  }
+
+  void reserve(size_t new_capacity)
+  {
+    if(new_capacity > capacity())
+    {
+      grow(new_capacity);
+    }
+  }
+
+  // new elements are zero bytes
+  void resize(size_t new_size)
+  {
+    reserve(new_size);
+    if(new_size > size())
+    {
+      std::memset(static_cast<void*>(data() + size()), 0, (new_size - size()) * sizeof(T));
+    }
+    header_->size = new_size;
+  }
+
+  void clear()
+  {
+    header_->size = 0;
+  }
+
+  template <typename... Args>
+  T& emplace_back(Args&&... args)
+  {
+    const T value(std::forward<Args>(args)...);    // args may refer to an element: copy before remapping
+    if(size() == capacity())
+    {
+      grow(std::max<size_t>(2 * capacity(), 4096 / sizeof(T) + 1));
+    }
+    T& slot = data()[header_->size++];
+    slot    = value;
+    return slot;
+  }
+
+  void push_back(const T& value)
+  {
+    emplace_back(value);
+  }
+
+  // writes the header and elements back and waits for the disk
+  void flush()
+  {
+    if(msync(header_, file_bytes(size()), MS_SYNC) != 0)
+    {
+      fail("MmapVector: msync");
+    }
+  }
+};
+#endif
+
+template <typename T, size_t size_>
+class Array
+{
+  static_assert(size_ > 0, "zero-length arrays are not supported");
+
+  public:
+  T data_[size_];    // public only so Array is an aggregate: Array<int, 3> a{1, 2, 3}
+
+  using value_type     = T;
+  using iterator       = T*;
+  using const_iterator = const T*;
+
+  constexpr T& operator[](size_t index)
+  {
+    return data_[index];
+  }
+
+  constexpr const T& operator[](size_t index) const
+  {
+    return data_[index];
+  }
+
+  constexpr T* data()
+  {
+    return data_;
+  }
+
+  constexpr const T* data() const
+  {
+    return data_;
+  }
+
+  constexpr size_t size() const
+  {
+    return size_;
+  }
+
+  constexpr iterator begin()
+  {
+    return data_;
+  }
+
+  constexpr iterator end()
+  {
+    return data_ + size_;
+  }
+
+  constexpr const_iterator begin() const
+  {
+    return data_;
+  }
+
+  constexpr const_iterator end() const
+  {
+    return data_ + size_;
+  }
+
+  constexpr void fill(const T& value)
+  {
+    for(T& element : data_)
+    {
+      element = value;
+    }
+  }
+
+  friend constexpr bool operator==(const Array&, const Array&) = default;
+  friend constexpr auto operator<=>(const Array&, const Array&) = default;
+};
+
+// tuple protocol for structured bindings: auto [x, y, z] = point;
+template <typename T, size_t size_>
+struct std::tuple_size<Array<T, size_>> : std::integral_constant<size_t, size_>
+{
+};
+
+template <size_t I, typename T, size_t size_>
+struct std::tuple_element<I, Array<T, size_>>
+{
+  using type = T;
+};
+
+template <size_t I, typename T, size_t size_>
+constexpr T& get(Array<T, size_>& array)
+{
+  static_assert(I < size_);
+  return array.data_[I];
+}
+
+template <size_t I, typename T, size_t size_>
+constexpr const T& get(const Array<T, size_>& array)
+{
+  static_assert(I < size_);
+  return array.data_[I];
+}
+
+template <size_t I, typename T, size_t size_>
+constexpr T&& get(Array<T, size_>&& array)
+{
+  static_assert(I < size_);
+  return std::move(array.data_[I]);
+}
+
+template <typename T>
+concept SimdArithmetic = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, long double>;
+
+enum class SimdLevel
+{
+  Scalar,
+  SSE2,
+  AVX2,
+  AVX512
+};
+
+inline SimdLevel simd_level()
+{
+  static const SimdLevel level = [] {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f"))
+    {
+      return SimdLevel::AVX512;
+    }
+    if(__builtin_cpu_supports("avx2"))
+    {
+      return SimdLevel::AVX2;
+    }
+    if(__builtin_cpu_supports("sse2"))
+    {
+      return SimdLevel::SSE2;
+    }
+#endif
+    return SimdLevel::Scalar;
+  }();
+  return level;
+}
+
+// Bytes-wide kernels; vectors are only passed by reference, so they never cross a call boundary
+// compiled for a narrower instruction set
+template <typename T, size_t Bytes>
+struct SimdOps
+{
+  // lane masks hold a signed integer as wide as T: all ones where true
+  using Lane = std::conditional_t<sizeof(T) == 1, int8_t,
+                                  std::conditional_t<sizeof(T) == 2, int16_t,
+                                                     std::conditional_t<sizeof(T) == 4, int32_t, int64_t>>>;
+
+  // integer sums wrap like a loop over T would, without signed overflow in the lanes
+  using Sum = typename std::conditional_t<std::is_integral_v<T>, std::make_unsigned<T>, std::type_identity<T>>::type;
+
+  typedef T    V __attribute__((vector_size(Bytes)));
+  typedef Lane M __attribute__((vector_size(Bytes)));
+  typedef Sum  S __attribute__((vector_size(Bytes)));
+
+  static constexpr size_t lanes = Bytes / sizeof(T);
+
+  static void load(V& v, const T* p)
+  {
+    std::memcpy(&v, p, Bytes);
+  }
+
+  static void store(T* p, const V& v)
+  {
+    std::memcpy(p, &v, Bytes);
+  }
+
+  static bool any(const M& mask)
+  {
+    if constexpr(Bytes % sizeof(uint64_t) == 0)
+    {
+      uint64_t words[Bytes / sizeof(uint64_t)];
+      std::memcpy(words, &mask, Bytes);
+      uint64_t bits = 0;
+      for(uint64_t word : words)
+      {
+        bits |= word;
+      }
+      return bits != 0;
+    }
+    else
+    {
+      for(size_t j = 0; j < lanes; j++)
+      {
+        if(mask[j])
+        {
+          return true;
+        }
+      }
+      return false;
+    }
+  }
+
+  static void fill(T* data, size_t n, T value)
+  {
+    const V v = V{} + value;
+    size_t  i = 0;
+    for(; i + lanes <= n; i += lanes)
+    {
+      store(data + i, v);
+    }
+    for(; i < n; i++)
+    {
+      data[i] = value;
+    }
+  }
+
+  // four independent accumulators hide the add latency
+  static T sum(const T* data, size_t n)
+  {
+    S      acc[4] = {};
+    S      v;
+    size_t i = 0;
+    for(; i + 4 * lanes <= n; i += 4 * lanes)
+    {
+      for(size_t k = 0; k < 4; k++)
+      {
+        std::memcpy(&v, data + i + k * lanes, Bytes);
+        acc[k] += v;
+      }
+    }
+    for(; i + lanes <= n; i += lanes)
+    {
+      std::memcpy(&v, data + i, Bytes);
+      acc[0] += v;
+    }
+    acc[0] += acc[1] + acc[2] + acc[3];
+    Sum total = 0;
+    for(size_t j = 0; j < lanes; j++)
+    {
+      total += acc[0][j];
+    }
+    for(; i < n; i++)
+    {
+      total += static_cast<Sum>(data[i]);
+    }
+    return static_cast<T>(total);
+  }
+
+  // n > 0
+  template <bool Max>
+  static T extreme(const T* data, size_t n)
+  {
+    T      best = data[0];
+    size_t i    = 0;
+    if(n >= lanes)
+    {
+      V acc;
+      V v;
+      load(acc, data);
+      for(i = lanes; i + lanes <= n; i += lanes)
+      {
+        load(v, data + i);
+        acc = (Max ? v > acc : v < acc) ? v : acc;
+      }
+      for(size_t j = 0; j < lanes; j++)
+      {
+        best = (Max ? acc[j] > best : acc[j] < best) ? acc[j] : best;
+      }
+    }
+    for(; i < n; i++)
+    {
+      best = (Max ? data[i] > best : data[i] < best) ? data[i] : best;
+    }
+    return best;
+  }
+
+  static size_t find(const T* data, size_t n, T value)
+  {
+    const V target = V{} + value;
+    V       v;
+    size_t  i = 0;
+    for(; i + lanes <= n; i += lanes)
+    {
+      load(v, data + i);
+      if(any(reinterpret_cast<M>(v == target)))
+      {
+        break;    // the scalar loop below pins down the lane
+      }
+    }
+    for(; i < n; i++)
+    {
+      if(data[i] == value)
+      {
+        return i;
+      }
+    }
+    return n;
+  }
+
+  static size_t count(const T* data, size_t n, T value)
+  {
+    // each lane counts down by one per match; fold into total before a narrow lane can overflow
+    constexpr size_t block  = std::min<size_t>(std::numeric_limits<Lane>::max(), size_t(1) << 20);
+    const V          target = V{} + value;
+    V                v;
+    size_t           total = 0;
+    size_t           i     = 0;
+    while(i + lanes <= n)
+    {
+      M counts = {};
+      for(size_t k = 0; k < block && i + lanes <= n; k++, i += lanes)
+      {
+        load(v, data + i);
+        counts += reinterpret_cast<M>(v == target);
+      }
+      for(size_t j = 0; j < lanes; j++)
+      {
+        total += static_cast<size_t>(-static_cast<int64_t>(counts[j]));
+      }
+    }
+    for(; i < n; i++)
+    {
+      total += data[i] == value;
+    }
+    return total;
+  }
+
+  // f maps T to T; the fixed-size chunk loop is what the compiler vectorizes at this width
+  template <typename F>
+  static void transform(const T* in, T* out, size_t n, F& f)
+  {
+    size_t i = 0;
+    for(; i + lanes <= n; i += lanes)
+    {
+      T chunk[lanes];
+      for(size_t j = 0; j < lanes; j++)
+      {
+        chunk[j] = f(in[i + j]);
+      }
+      std::memcpy(out + i, chunk, Bytes);
+    }
+    for(; i < n; i++)
+    {
+      out[i] = f(in[i]);
+    }
+  }
+};
+
+// entry points: flatten inlines the whole kernel, so it is compiled for the target's instruction set
+#if defined(__x86_64__) || defined(__i386__)
+template <typename Kernel>
+[[gnu::target("avx512f"), gnu::flatten]] auto simd_avx512(Kernel& kernel)
+{
+  return kernel.template operator()<64>();
+}
+
+template <typename Kernel>
+[[gnu::target("avx2"), gnu::flatten]] auto simd_avx2(Kernel& kernel)
+{
+  return kernel.template operator()<32>();
+}
+
+template <typename Kernel>
+[[gnu::target("sse2"), gnu::flatten]] auto simd_sse2(Kernel& kernel)
+{
+  return kernel.template operator()<16>();
+}
+#endif
+
+// kernel is a lambda templated on the vector width in bytes
+template <typename T, typename Kernel>
+auto simd_dispatch(Kernel kernel)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  switch(simd_level())
+  {
+    case SimdLevel::AVX512:
+      return simd_avx512(kernel);
+    case SimdLevel::AVX2:
+      return simd_avx2(kernel);
+    case SimdLevel::SSE2:
+      return simd_sse2(kernel);
+    case SimdLevel::Scalar:
+      break;
+  }
+#endif
+  return kernel.template operator()<sizeof(T)>();
+}
+
+template <typename Container, typename T = typename Container::value_type>
+  requires SimdArithmetic<T>
+void simd_fill(Container& container, T value)
+{
+  T* const     data = container.data();
+  const size_t n    = container.size();
+  simd_dispatch<T>([&]<size_t Bytes>() { SimdOps<T, Bytes>::fill(data, n, value); });
+}
+
+template <typename Container, typename T = typename Container::value_type>
+  requires SimdArithmetic<T>
+T simd_sum(const Container& container)
+{
+  const T* const data = container.data();
+  const size_t   n    = container.size();
+  return simd_dispatch<T>([&]<size_t Bytes>() { return SimdOps<T, Bytes>::sum(data, n); });
+}
+
+// container must not be empty
+template <typename Container, typename T = typename Container::value_type>
+  requires SimdArithmetic<T>
+T simd_min(const Container& container)
+{
+  const T* const data = container.data();
+  const size_t   n    = container.size();
+  return simd_dispatch<T>([&]<size_t Bytes>() { return SimdOps<T, Bytes>::template extreme<false>(data, n); });
+}
+
+// container must not be empty
+template <typename Container, typename T = typename Container::value_type>
+  requires SimdArithmetic<T>
+T simd_max(const Container& container)
+{
+  const T* const data = container.data();
+  const size_t   n    = container.size();
+  return simd_dispatch<T>([&]<size_t Bytes>() { return SimdOps<T, Bytes>::template extreme<true>(data, n); });
+}
+
+// index of the first element equal to value, size() if there is none
+template <typename Container, typename T = typename Container::value_type>
+  requires SimdArithmetic<T>
+size_t simd_find(const Container& container, T value)
+{
+  const T* const data = container.data();
+  const size_t   n    = container.size();
+  return simd_dispatch<T>([&]<size_t Bytes>() { return SimdOps<T, Bytes>::find(data, n, value); });
+}
+
+template <typename Container, typename T = typename Container::value_type>
+  requires SimdArithmetic<T>
+size_t simd_count(const Container& container, T value)
+{
+  const T* const data = container.data();
+  const size_t   n    = container.size();
+  return simd_dispatch<T>([&]<size_t Bytes>() { return SimdOps<T, Bytes>::count(data, n, value); });
+}
+
+// out[i] = f(in[i]); out must hold at least in.size() elements and may be in itself
+template <typename In, typename Out, typename F, typename T = typename In::value_type>
+  requires SimdArithmetic<T> && std::is_same_v<T, typename Out::value_type>
+void simd_transform(const In& in, Out& out, F f)
+{
+  const T* const input  = in.data();
+  T* const       output = out.data();
+  const size_t   n      = in.size();
+  simd_dispatch<T>([&]<size_t Bytes>() { SimdOps<T, Bytes>::transform(input, output, n, f); });
+}
+
+// to must hold at least from.size() elements
+template <typename From, typename To, typename T = typename From::value_type>
+  requires SimdArithmetic<T> && std::is_same_v<T, typename To::value_type>
+void simd_copy(const From& from, To& to)
+{
+  if(from.size() > 0)
+  {
+    std::memcpy(to.data(), from.data(), from.size() * sizeof(T));
+  }
+}
+
+void benchmark_small_vector()
+{
+  constexpr size_t rounds = 200000;
+
+  // builds rounds vectors of n elements; returns allocations per vector, ns per vector and a checksum.
+  // allocations are counted in a separate untimed build: every capacity change of Vector or SmallVector
+  // (leaving the inline buffer included) is exactly one heap allocation
+  auto run = [](auto make, size_t n) {
+    size_t allocations = 0;
+    {
+      auto   vec      = make();
+      size_t capacity = vec.capacity();
+      for(size_t i = 0; i < n; i++)
+      {
+        vec.push_back(static_cast<int>(i));
+        if(vec.capacity() != capacity)
+        {
+          allocations++;
+          capacity = vec.capacity();
+        }
+      }
+    }
+
+    size_t checksum = 0;
+    auto   start    = std::chrono::steady_clock::now();
+    for(size_t round = 0; round < rounds; round++)
+    {
+      auto vec = make();
+      for(size_t i = 0; i < n; i++)
+      {
+        vec.push_back(static_cast<int>(round + i));
+      }
+      checksum += static_cast<size_t>(vec[n / 2]);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return std::tuple{allocations, elapsed.count() / rounds, checksum};
+  };
+
+  std::cout << "size  Vector allocs  ns    SmallVector<int, 8> allocs  ns" << std::endl;
+  for(size_t n : {1, 2, 4, 8, 16, 32, 64})
+  {
+    const auto [vector_allocs, vector_ns, vector_sum] = run([] { return Vector<int>(); }, n);
+    const auto [small_allocs, small_ns, small_sum]    = run([] { return SmallVector<int, 8>(); }, n);
+    std::cout << n << "\t" << vector_allocs << "\t" << vector_ns << "\t" << small_allocs << "\t" << small_ns << "\t("
+              << (vector_sum + small_sum) % 10 << ")" << std::endl;
+  }
+}
+
+void benchmark_simd()
+{
+  constexpr size_t n      = size_t(1) << 22;
+  constexpr int    rounds = 20;
+
+  Vector<int> data(n);
+  Vector<int> out(n);
+  for(size_t i = 0; i < n; i++)
+  {
+    data[i] = static_cast<int>((i * 2654435761u) % 1000003);
+  }
+  const int missing = -1;    // find scans everything
+
+  // ns per element of the best round
+  auto time = [&](auto body) {
+    double best = 1e30;
+    for(int round = 0; round < rounds; round++)
+    {
+      auto start = std::chrono::steady_clock::now();
+      body();
+      std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+      best = std::min(best, elapsed.count() / n);
+    }
+    return best;
+  };
+
+  size_t sink = 0;
+  auto   row  = [&](const char* name, auto naive, auto simd) {
+    const double naive_ns = time(naive);
+    const double simd_ns  = time(simd);
+    std::cout << name << "\t" << naive_ns << "\t\t" << simd_ns << std::endl;
+  };
+
+  const char* levels[] = {"scalar", "SSE2", "AVX2", "AVX-512"};
+  std::cout << "simd level: " << levels[static_cast<int>(simd_level())] << ", " << n << " ints" << std::endl;
+  std::cout << "op\tnaive (ns/elem)\tsimd (ns/elem)" << std::endl;
+  row(
+      "fill",
+      [&] {
+        for(size_t i = 0; i < n; i++)
+          out[i] = 7;
+      },
+      [&] { simd_fill(out, 7); });
+  row(
+      "sum",
+      [&] {
+        int total = 0;
+        for(size_t i = 0; i < n; i++)
+          total += data[i];
+        sink += static_cast<size_t>(total);
+      },
+      [&] { sink += static_cast<size_t>(simd_sum(data)); });
+  row(
+      "min",
+      [&] {
+        int best = data[0];
+        for(size_t i = 1; i < n; i++)
+          best = data[i] < best ? data[i] : best;
+        sink += static_cast<size_t>(best);
+      },
+      [&] { sink += static_cast<size_t>(simd_min(data)); });
+  row(
+      "max",
+      [&] {
+        int best = data[0];
+        for(size_t i = 1; i < n; i++)
+          best = data[i] > best ? data[i] : best;
+        sink += static_cast<size_t>(best);
+      },
+      [&] { sink += static_cast<size_t>(simd_max(data)); });
+  row(
+      "find",
+      [&] {
+        size_t i = 0;
+        while(i < n && data[i] != missing)
+          i++;
+        sink += i;
+      },
+      [&] { sink += simd_find(data, missing); });
+  row(
+      "count",
+      [&] {
+        size_t count = 0;
+        for(size_t i = 0; i < n; i++)
+          count += data[i] == 42;
+        sink += count;
+      },
+      [&] { sink += simd_count(data, 42); });
+  row(
+      "transform",
+      [&] {
+        for(size_t i = 0; i < n; i++)
+          out[i] = data[i] * 3 + 1;
+      },
+      [&] { simd_transform(data, out, [](int x) { return x * 3 + 1; }); });
+  row(
+      "copy",
+      [&] {
+        for(size_t i = 0; i < n; i++)
+          out[i] = data[i];
+      },
+      [&] { simd_copy(data, out); });
+  std::cout << "(checksum " << sink + static_cast<size_t>(out[n - 1]) << ")" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  Vector<int> vec;
+  vec.push_back(10);
+  vec.push_back(2);
+  for(int i = 0; i < vec.size(); i++)
+    std::cout << vec[i] << '\n';
+
+  Vector<std::string> words;
+  words.reserve(2);
+  words.emplace_back(3, 'a');
+  words.push_back("bb");
+  words.push_back(words[0]);    // grows while copying one of its own elements
+  Vector<std::string> moved = std::move(words);
+  moved.shrink_to_fit();
+  for(size_t i = 0; i < moved.size(); i++)
+    std::cout << moved[i] << ' ';
+  std::cout << moved.capacity() << '\n';
+
+  // 1.5x growth, 64-byte aligned, buffers from 4 MiB up mapped in huge pages and grown with mremap
+  Vector<double, HalfAgainGrowth, 64, size_t(4) << 20> samples;
+  for(int i = 0; i < 1000000; i++)
+    samples.push_back(i * 0.5);
+  std::cout << samples[999999] << ' ' << reinterpret_cast<uintptr_t>(&samples[0]) % 64 << ' ' << samples.capacity()
+            << '\n';
+
+  simd_transform(samples, samples, [](double x) { return x * 2; });
+  std::cout << simd_sum(samples) << ' ' << simd_max(samples) << ' ' << simd_find(samples, 10.0) << ' '
+            << simd_count(samples, 4.0) << '\n';
+
+  // survives the process: a restart maps the file instead of rebuilding the data;
+  // the demo file is a fresh mkstemp file in the temp directory, so nothing in the working directory is touched
+  std::string path = (std::filesystem::temp_directory_path() / "vector_array_demo.XXXXXX").string();
+  const int   fd   = mkstemp(path.data());
+  if(fd < 0)
+  {
+    throw std::system_error(errno, std::generic_category(), "mkstemp");
+  }
+  close(fd);
+  {
+    MmapVector<double> stored(path.c_str());
+    stored.clear();
+    for(int i = 0; i < 10000; i++)
+      stored.push_back(i * 0.25);
+    stored.flush();
+  }
+  MmapVector<double> reopened(path.c_str());
+  std::cout << reopened.size() << ' ' << reopened[9999] << ' ' << simd_sum(reopened) << '\n';
+  std::remove(path.c_str());
+
+  SmallVector<std::string, 4> small;
+  for(int i = 0; i < 6; i++)
+    small.emplace_back(std::to_string(i));    // spills to the heap on the fifth element
+  small.push_back(small[0]);
+  for(size_t i = 0; i < small.size(); i++)
+    std::cout << small[i] << ' ';
+  std::cout << small.capacity() << '\n';
+
+  Array<int, 3> arr{};
+  arr[1] = 9;
+  for(int i = 0; i < arr.size(); i++)
+    std::cout << arr[i] << '\n';
+
+  // lookup tables computed by the compiler
+  constexpr Array<int8_t, 256> hex_values = [] {
+    Array<int8_t, 256> table{};
+    table.fill(-1);
+    for(int c = 0; c < 10; c++)
+      table['0' + c] = static_cast<int8_t>(c);
+    for(int c = 0; c < 6; c++)
+      table['a' + c] = table['A' + c] = static_cast<int8_t>(10 + c);
+    return table;
+  }();
+  static_assert(hex_values['F'] == 15 && hex_values['g'] == -1);
+
+  constexpr Array<int, 8> first_primes = [] {
+    Vector<int> primes;    // scratch space, freed before the constant expression ends
+    for(int n = 2; primes.size() < 8; n++)
+    {
+      bool prime = true;
+      for(size_t i = 0; i < primes.size(); i++)
+        prime = prime && n % primes[i] != 0;
+      if(prime)
+        primes.push_back(n);
+    }
+    Array<int, 8> table{};
+    for(size_t i = 0; i < table.size(); i++)
+      table[i] = primes[i];
+    return table;
+  }();
+  static_assert(first_primes[7] == 19 && first_primes < Array<int, 8>{2, 3, 5, 7, 11, 13, 17, 23});
+
+  constexpr Array<int, 3> point{1, 2, 3};
+  auto [x, y, z] = point;
+  for(int prime : first_primes)
+    std::cout << prime << ' ';
+  std::cout << x + y + z << ' ' << (point == Array<int, 3>{1, 2, 3}) << '\n';
+
+  if(argc > 1 && std::string_view(argv[1]) == "--bench")
+  {
+    benchmark_small_vector();
+    benchmark_simd();
+  }
   return 0;
 }
\ No newline at end of file